@@ -1,6 +1,7 @@
 #pragma once
 
 #include <hyprutils/memory/SharedPtr.hpp>
+#include <functional>
 
 namespace Hyprwire {
     class IProtocolClientImplementation;
@@ -11,11 +12,25 @@ namespace Hyprwire {
       public:
         virtual ~IClientSocket() = default;
 
+        /*
+            Open a client socket.
+        */
         static Hyprutils::Memory::CSharedPointer<IClientSocket> open(const std::string& path);
 
         // IClientSocket takes ownership of the fd.
         static Hyprutils::Memory::CSharedPointer<IClientSocket> open(const int fd);
 
+        /*
+            Open a client socket, optionally optimistic.
+            With optimistic set, the handshake is pipelined: the version ack and any binds are sent together with the
+            initial hello on the first dispatch, without waiting for the server. bindProtocol can then be called right away
+            with the implementation's spec, and calls on the returned objects are sent once the handshake completes.
+            If the server doesn't support our preferred version, a path socket reconnects and replays the binds, an fd socket fails.
+            Binds the server turns out not to support are dropped with an error, check getSpec() after the handshake if you need to know.
+        */
+        static Hyprutils::Memory::CSharedPointer<IClientSocket> open(const std::string& path, bool optimistic);
+        static Hyprutils::Memory::CSharedPointer<IClientSocket> open(const int fd, bool optimistic);
+
         /*
             Add an implementation to the socket
         */
@@ -42,7 +57,8 @@ namespace Hyprwire {
         virtual Hyprutils::Memory::CSharedPointer<IProtocolSpec> getSpec(const std::string& name) = 0;
 
         /*
-            Bind a protocol object
+            Bind a protocol object.
+            Returns nullptr if the server refuses the bind. Optimistic binds return right away, see open().
         */
         virtual Hyprutils::Memory::CSharedPointer<IObject> bindProtocol(const Hyprutils::Memory::CSharedPointer<IProtocolSpec>& spec, uint32_t version) = 0;
 
@@ -66,6 +82,13 @@ namespace Hyprwire {
         */
         virtual Hyprutils::Memory::CSharedPointer<IObject> objectForSeq(uint32_t seq) = 0;
 
+        /*
+            Request a roundtrip without blocking. The callback is called from dispatchEvents
+            once the server has processed everything sent before this call.
+            Any number of roundtrips can be outstanding, callbacks are called in request order.
+        */
+        virtual void roundtripAsync(std::function<void()>&& callback) = 0;
+
       protected:
         IClientSocket() = default;
     };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <hyprutils/memory/SharedPtr.hpp>
+#include <vector>
 
 namespace Hyprwire {
     class IProtocolServerImplementation;
@@ -57,6 +58,13 @@ namespace Hyprwire {
         */
         virtual bool removeClient(int fd) = 0;
 
+        /*
+            Send the same event to many objects of the same interface. The event is encoded once,
+            only the object id is patched per target. Targets with a version older than the method's since are skipped.
+            Args are the same as for IObject::call.
+        */
+        virtual void broadcast(const std::vector<Hyprutils::Memory::CSharedPointer<IObject>>& targets, uint32_t method, ...) = 0;
+
       protected:
         IServerSocket() = default;
     };
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <hyprutils/memory/SharedPtr.hpp>
+#include <cstdint>
 #include <functional>
+#include <span>
 #include <string_view>
 
 namespace Hyprwire {
@@ -31,6 +33,36 @@ namespace Hyprwire {
         // only for client objects
         virtual Hyprutils::Memory::CSharedPointer<IClientSocket> clientSock();
 
+        // fn(IObject*, void** args) collects a call, done(IObject*) is called once a run of consecutive calls to id within one read ends.
+        // args points to the decoded arguments, one slot per listener arg, with varchars and string arrays as for setArgViews(true).
+        virtual void                                       listenBatch(uint32_t id, void* fn, void* done) = 0;
+
+        // listeners get varchars as (const char*, uint32_t len) without a NUL, and string arrays as std::string_view*.
+        // Both point into the receive buffer and are only valid during the call.
+        virtual void                                       setArgViews(bool views) = 0;
+
+        // varchars (also in arrays) that aren't valid UTF-8 are a protocol error instead of reaching the listener.
+        virtual void                                       setStrictUtf8(bool strict) = 0;
+
+        // stream arguments: open a stream, pass its id to the call, then write the payload in pieces and close it.
+        // openStream returns 0 if the object can't stream yet (a client object still waiting for its id).
+        // writeStream returns how many bytes of data it took. Less than all of them if the other side is behind, write the rest
+        // from onStreamWritable then. 0 if the stream isn't open.
+        virtual uint32_t                                   openStream()                                                = 0;
+        virtual size_t                                     writeStream(uint32_t stream, std::span<const uint8_t> data) = 0;
+        virtual void                                       closeStream(uint32_t stream)                                = 0;
+
+        // fn gets a stream we received the id of chunk by chunk as it arrives, and done = true with no data once it's closed.
+        // Chunks point into the receive buffer and are only valid during the call. Call this from the listener that got the id.
+        virtual void listenStream(uint32_t stream, std::function<void(std::span<const uint8_t> chunk, bool done)>&& fn) = 0;
+
+        // cached fd arguments stay open on the other side once sent. This closes the other side's copy of fd's file, call it
+        // before closing fd. Does nothing if it wasn't cached.
+        virtual void                                       releaseFd(int fd) = 0;
+
+        // fn is called once, when writeStream takes data for stream again. Right away if it already does.
+        virtual void                                       onStreamWritable(uint32_t stream, std::function<void()>&& fn) = 0;
+
       protected:
         IObject() = default;
 
@@ -3,14 +3,48 @@
 #include <hyprutils/memory/SharedPtr.hpp>
 #include <vector>
 #include <cstdint>
+#include <string>
 
 namespace Hyprwire {
 
+    enum eMethodCoalesce : uint8_t {
+        HW_METHOD_COALESCE_NONE = 0,
+
+        /*
+            Only the latest value matters. If the event is still queued (unsent) for the same object,
+            it's replaced in place by the new one.
+        */
+        HW_METHOD_COALESCE_LATEST,
+    };
+
+    enum eMethodPriority : uint8_t {
+        HW_METHOD_PRIORITY_NORMAL = 0,
+
+        /*
+            Latency-critical. If the server has a backlog for the client, the event skips ahead of queued bulk events,
+            unless one of them is for the same object.
+        */
+        HW_METHOD_PRIORITY_HIGH,
+    };
+
     struct SMethod {
         uint32_t             idx = 0;
         std::vector<uint8_t> params;
         std::string          returnsType = "";
         uint32_t             since       = 0;
+        eMethodCoalesce      coalesce    = HW_METHOD_COALESCE_NONE;
+        eMethodPriority      priority    = HW_METHOD_PRIORITY_NORMAL;
+
+        /*
+            If every argument (and the seq, for methods that return an object) is a 4-byte scalar, the size of the args
+            on the wire including END, otherwise 0. Such messages are checked and decoded at fixed offsets.
+        */
+        uint32_t fixedSize = 0;
+
+        /*
+            Object names of the OBJECT_ID params, in order. Received ids have to refer to an object of that type.
+        */
+        std::vector<std::string> objectTypes;
     };
 
     class IProtocolObjectSpec {
@@ -11,7 +11,7 @@ namespace Hyprwire {
 
         /*
             Primitive type identifiers. These are all 4 bytes.
-            SEQ and OBJECT_ID are U32.
+            SEQ and OBJECT_ID are U32. OBJECT_ID is an object of the same connection, or 0 for none.
         */
         HW_MESSAGE_MAGIC_TYPE_UINT      = 0x10,
         HW_MESSAGE_MAGIC_TYPE_INT       = 0x11,
@@ -19,6 +19,13 @@ namespace Hyprwire {
         HW_MESSAGE_MAGIC_TYPE_SEQ       = 0x13,
         HW_MESSAGE_MAGIC_TYPE_OBJECT_ID = 0x14,
 
+        /*
+            8 byte primitives.
+        */
+        HW_MESSAGE_MAGIC_TYPE_U64 = 0x15,
+        HW_MESSAGE_MAGIC_TYPE_I64 = 0x16,
+        HW_MESSAGE_MAGIC_TYPE_F64 = 0x17,
+
         /*
             Variable length types.
 
@@ -39,6 +46,45 @@ namespace Hyprwire {
         */
         HW_MESSAGE_MAGIC_TYPE_ARRAY = 0x21,
 
+        /*
+            [magic : 1B][type : 1B][n_els : VLQ][pad : 1B][pad B of zeroes]{ [data...] }
+
+            An ARRAY of UINT, INT, F32, U64, I64 or F64 whose data starts at a multiple of 16 bytes from the start of the message,
+            so that it can be read in place. Needs HW_PROTOCOL_FEATURE_ALIGNED_ARRAYS.
+        */
+        HW_MESSAGE_MAGIC_TYPE_ALIGNED_ARRAY = 0x23,
+
+        /*
+            Only valid as the type of an ARRAY, for records declared with <struct> in the protocol:
+            [magic : 1B][STRUCT : 1B][n_els : VLQ][el_size : VLQ]{ [data : n_els * el_size B] }
+
+            Each element is its UINT / INT / F32 fields back to back, without magics.
+            In SMethod::params, STRUCT is followed by the element size.
+        */
+        HW_MESSAGE_MAGIC_TYPE_STRUCT = 0x24,
+
+        /*
+            [magic : 1B][stream id : 4B]
+
+            The payload follows in STREAM_DATA messages with that stream id, sent after this message.
+        */
+        HW_MESSAGE_MAGIC_TYPE_STREAM = 0x25,
+
+        /*
+            [magic : 1B][id : VLQ]
+
+            A VARCHAR the sender defined with STRING_DEFINE before. Needs HW_PROTOCOL_FEATURE_STRING_TABLE, never in an ARRAY.
+        */
+        HW_MESSAGE_MAGIC_TYPE_VARCHAR_REF = 0x26,
+
+        /*
+            Only valid as the type of an ARRAY of UINT, INT, U64 or I64 declared with an encoding in the protocol:
+            [magic : 1B][PACKED : 1B][n_els : VLQ][type : 1B][encoding : 1B][size : VLQ]{ [data : size B] }
+
+            The data is the elements encoded as eArrayEncoding says. In SMethod::params, PACKED is followed by the type and the encoding.
+        */
+        HW_MESSAGE_MAGIC_TYPE_PACKED = 0x27,
+
         /*
             [magic : 1B][id : UINT][name_len : VLQ][object name ...]
         */
@@ -55,5 +101,36 @@ namespace Hyprwire {
             and should be read with recvmsg.
         */
         HW_MESSAGE_MAGIC_TYPE_FD = 0x40,
+
+        /*
+            [magic : 1B][id : VLQ]
+
+            An fd the sender defined with FD_DEFINE before, which stays open on the receiving side. Needs HW_PROTOCOL_FEATURE_FD_CACHE.
+            In SMethod::params, CACHED_FD is an fd arg that may be sent either as this or as FD. Its fd belongs to the connection,
+            listeners don't close it.
+        */
+        HW_MESSAGE_MAGIC_TYPE_CACHED_FD = 0x41,
+    };
+
+    /*
+        How the elements of a PACKED array are encoded. Signed values (and deltas) are zigzag encoded first: n << 1 for n >= 0, (-n << 1) - 1 otherwise.
+    */
+    enum eArrayEncoding : uint8_t {
+        HW_ARRAY_ENCODING_NONE = 0,
+
+        /*
+            Each element as a VLQ.
+        */
+        HW_ARRAY_ENCODING_VARINT = 1,
+
+        /*
+            Each element as a VLQ of its difference to the previous one, in the element's width. The first one is relative to 0.
+        */
+        HW_ARRAY_ENCODING_DELTA_VARINT = 2,
+
+        /*
+            Runs of equal elements, each as [value : VLQ][run length : VLQ]. Runs are at least 1 long.
+        */
+        HW_ARRAY_ENCODING_RLE = 3,
     };
 };
\ No newline at end of file
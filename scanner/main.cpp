@@ -12,20 +12,25 @@
 #include <hyprwire/core/types/MessageMagic.hpp>
 
 struct SRequestArgument {
-    Hyprwire::eMessageMagic magic = Hyprwire::HW_MESSAGE_MAGIC_END, arrType = Hyprwire::HW_MESSAGE_MAGIC_END;
-    std::string             interface;
-    std::string             name;
-    bool                    allowNull = false;
-    bool                    isEnum    = false;
+    Hyprwire::eMessageMagic  magic = Hyprwire::HW_MESSAGE_MAGIC_END, arrType = Hyprwire::HW_MESSAGE_MAGIC_END;
+    std::string              interface;
+    std::string              name;
+    bool                     allowNull = false;
+    bool                     isEnum    = false;
+    std::string              structType; // C type of the elements of an array struct:<name>
+    Hyprwire::eArrayEncoding encoding = Hyprwire::HW_ARRAY_ENCODING_NONE; // array <int type> with encoding=""
+    bool                     cached   = false;                            // fd with cache="true"
 };
 
 struct SMethodSpec {
     std::vector<SRequestArgument> args;
     std::string                   name;
     uint32_t                      since;
-    std::string                   returns    = "";
-    bool                          destructor = false;
-    uint32_t                      idx        = 0;
+    std::string                   returns      = "";
+    bool                          destructor   = false;
+    bool                          coalesce     = false;
+    bool                          highPriority = false;
+    uint32_t                      idx          = 0;
 };
 
 struct SObjectSpec {
@@ -40,10 +45,18 @@ struct SEnumSpec {
     std::vector<std::pair<uint32_t, std::string>> entries;
 };
 
+struct SStructSpec {
+    std::string                                                name, cType;
+    std::vector<std::pair<std::string, Hyprwire::eMessageMagic>> fields;
+};
+
 static std::vector<SObjectSpec> OBJECT_SPECS;
 static std::vector<SEnumSpec>   ENUM_SPECS;
+static std::vector<SStructSpec> STRUCT_SPECS;
 
 static bool                     clientCode = false;
+static bool                     viewArgs   = false;
+static bool                     strictUtf8 = false;
 
 static std::string              HEADER_PROTOCOL, HEADER_IMPL;
 static std::string              SOURCE;
@@ -96,10 +109,20 @@ static Hyprwire::eMessageMagic strToMagic(const std::string_view& sv) {
         return Hyprwire::HW_MESSAGE_MAGIC_TYPE_INT;
     if (sv == "f32")
         return Hyprwire::HW_MESSAGE_MAGIC_TYPE_F32;
+    if (sv == "u64")
+        return Hyprwire::HW_MESSAGE_MAGIC_TYPE_U64;
+    if (sv == "i64")
+        return Hyprwire::HW_MESSAGE_MAGIC_TYPE_I64;
+    if (sv == "f64")
+        return Hyprwire::HW_MESSAGE_MAGIC_TYPE_F64;
     if (sv == "fd")
         return Hyprwire::HW_MESSAGE_MAGIC_TYPE_FD;
-    // if (sv == "object")
-    //     return Hyprwire::HW_MESSAGE_MAGIC_TYPE_OBJECT_ID;
+    if (sv == "stream")
+        return Hyprwire::HW_MESSAGE_MAGIC_TYPE_STREAM;
+    if (sv == "object")
+        return Hyprwire::HW_MESSAGE_MAGIC_TYPE_OBJECT_ID;
+    if (sv.starts_with("struct:"))
+        return Hyprwire::HW_MESSAGE_MAGIC_TYPE_STRUCT;
     if (sv.starts_with("array "))
         return Hyprwire::HW_MESSAGE_MAGIC_TYPE_ARRAY;
     return Hyprwire::HW_MESSAGE_MAGIC_END;
@@ -111,7 +134,13 @@ static std::string magicToString(Hyprwire::eMessageMagic m, Hyprwire::eMessageMa
         case Hyprwire::HW_MESSAGE_MAGIC_TYPE_UINT: return "Hyprwire::HW_MESSAGE_MAGIC_TYPE_UINT";
         case Hyprwire::HW_MESSAGE_MAGIC_TYPE_INT: return "Hyprwire::HW_MESSAGE_MAGIC_TYPE_INT";
         case Hyprwire::HW_MESSAGE_MAGIC_TYPE_F32: return "Hyprwire::HW_MESSAGE_MAGIC_TYPE_F32";
+        case Hyprwire::HW_MESSAGE_MAGIC_TYPE_U64: return "Hyprwire::HW_MESSAGE_MAGIC_TYPE_U64";
+        case Hyprwire::HW_MESSAGE_MAGIC_TYPE_I64: return "Hyprwire::HW_MESSAGE_MAGIC_TYPE_I64";
+        case Hyprwire::HW_MESSAGE_MAGIC_TYPE_F64: return "Hyprwire::HW_MESSAGE_MAGIC_TYPE_F64";
         case Hyprwire::HW_MESSAGE_MAGIC_TYPE_FD: return "Hyprwire::HW_MESSAGE_MAGIC_TYPE_FD";
+        case Hyprwire::HW_MESSAGE_MAGIC_TYPE_STRUCT: return "Hyprwire::HW_MESSAGE_MAGIC_TYPE_STRUCT";
+        case Hyprwire::HW_MESSAGE_MAGIC_TYPE_STREAM: return "Hyprwire::HW_MESSAGE_MAGIC_TYPE_STREAM";
+        case Hyprwire::HW_MESSAGE_MAGIC_TYPE_OBJECT_ID: return "Hyprwire::HW_MESSAGE_MAGIC_TYPE_OBJECT_ID";
         case Hyprwire::HW_MESSAGE_MAGIC_TYPE_ARRAY: return "Hyprwire::HW_MESSAGE_MAGIC_TYPE_ARRAY, " + magicToString(arrType);
         default: return "";
     }
@@ -123,11 +152,31 @@ static std::string argToC(Hyprwire::eMessageMagic m) {
         case Hyprwire::HW_MESSAGE_MAGIC_TYPE_UINT: return "uint32_t";
         case Hyprwire::HW_MESSAGE_MAGIC_TYPE_INT: return "int32_t";
         case Hyprwire::HW_MESSAGE_MAGIC_TYPE_F32: return "float";
+        case Hyprwire::HW_MESSAGE_MAGIC_TYPE_U64: return "uint64_t";
+        case Hyprwire::HW_MESSAGE_MAGIC_TYPE_I64: return "int64_t";
+        case Hyprwire::HW_MESSAGE_MAGIC_TYPE_F64: return "double";
         case Hyprwire::HW_MESSAGE_MAGIC_TYPE_FD: return "int";
+        case Hyprwire::HW_MESSAGE_MAGIC_TYPE_STREAM: return "uint32_t";
         default: return "";
     }
 }
 
+// generated class of an object arg's interface
+static std::string objectWrapper(const SRequestArgument& arg) {
+    return std::format("{}{}Object", clientCode ? "CC" : "C", capitalize(camelize(arg.interface)));
+}
+
+// object arg as the library passes it (Hyprwire::IObject*) converted to its wrapper
+static std::string objectFromIObject(const SRequestArgument& arg) {
+    return std::format("{} ? rc<{}*>({}->getData()) : nullptr", arg.name, objectWrapper(arg), arg.name);
+}
+
+static std::string arrElemToC(const SRequestArgument& arg) {
+    if (arg.arrType == Hyprwire::HW_MESSAGE_MAGIC_TYPE_STRUCT)
+        return arg.structType;
+    return argToC(arg.arrType);
+}
+
 static std::string argToC(const SRequestArgument& arg) {
     switch (arg.magic) {
         case Hyprwire::HW_MESSAGE_MAGIC_TYPE_VARCHAR: return "const char*";
@@ -139,12 +188,51 @@ static std::string argToC(const SRequestArgument& arg) {
         }
         case Hyprwire::HW_MESSAGE_MAGIC_TYPE_INT: return "int32_t";
         case Hyprwire::HW_MESSAGE_MAGIC_TYPE_F32: return "float";
+        case Hyprwire::HW_MESSAGE_MAGIC_TYPE_U64: return "uint64_t";
+        case Hyprwire::HW_MESSAGE_MAGIC_TYPE_I64: return "int64_t";
+        case Hyprwire::HW_MESSAGE_MAGIC_TYPE_F64: return "double";
         case Hyprwire::HW_MESSAGE_MAGIC_TYPE_FD: return "int";
-        case Hyprwire::HW_MESSAGE_MAGIC_TYPE_ARRAY: return "const std::vector<" + argToC(arg.arrType) + ">&";
+        case Hyprwire::HW_MESSAGE_MAGIC_TYPE_STREAM: return "uint32_t";
+        case Hyprwire::HW_MESSAGE_MAGIC_TYPE_OBJECT_ID: return objectWrapper(arg) + "*";
+        case Hyprwire::HW_MESSAGE_MAGIC_TYPE_ARRAY: return "const std::vector<" + arrElemToC(arg) + ">&";
         default: return "";
     }
 }
 
+// owning type a batched call keeps its argument in
+static std::string argToStorage(const SRequestArgument& arg) {
+    switch (arg.magic) {
+        case Hyprwire::HW_MESSAGE_MAGIC_TYPE_VARCHAR: return "std::string";
+        case Hyprwire::HW_MESSAGE_MAGIC_TYPE_ARRAY: return "std::vector<" + (arg.arrType == Hyprwire::HW_MESSAGE_MAGIC_TYPE_VARCHAR ? "std::string" : arrElemToC(arg)) + ">";
+        default: return argToC(arg);
+    }
+}
+
+// tuple holding one batched call, types only
+static std::string argsToTuple(const std::vector<SRequestArgument>& args) {
+    std::string cstr;
+    for (const auto& m : args) {
+        cstr += argToStorage(m) + ", ";
+    }
+
+    if (!cstr.empty())
+        cstr = cstr.substr(0, cstr.size() - 2);
+
+    return "std::tuple<" + cstr + ">";
+}
+
+// size of the args on the wire if they're all 4-byte scalars, see SMethod::fixedSize
+static uint32_t fixedWireSize(const SMethodSpec& m) {
+    uint32_t size = m.returns.empty() ? 1 : 6;
+    for (const auto& a : m.args) {
+        if (a.magic != Hyprwire::HW_MESSAGE_MAGIC_TYPE_UINT && a.magic != Hyprwire::HW_MESSAGE_MAGIC_TYPE_INT && a.magic != Hyprwire::HW_MESSAGE_MAGIC_TYPE_F32)
+            return 0;
+        size += 5;
+    }
+
+    return size;
+}
+
 static std::string argsToC(const std::vector<SRequestArgument>& args, bool noNames = false, bool noTypes = false, bool addSequence = false, bool pureC = false, bool unC = false) {
     std::string cstr;
 
@@ -165,19 +253,26 @@ static std::string argsToC(const std::vector<SRequestArgument>& args, bool noNam
                 cstr += std::format("{}.data(), (uint32_t){}.size(), ", m.name, m.name);
             else {
                 if (noNames)
-                    cstr += std::format("{}*, uint32_t, ", argToC(m.arrType));
+                    cstr += std::format("{}*, uint32_t, ", arrElemToC(m));
                 else
-                    cstr += std::format("{}* {}, uint32_t {}, ", argToC(m.arrType), m.name, m.name + "_len");
+                    cstr += std::format("{}* {}, uint32_t {}, ", arrElemToC(m), m.name, m.name + "_len");
             }
         } else if (m.arrType != Hyprwire::HW_MESSAGE_MAGIC_END && unC) {
             if (noTypes)
-                cstr += std::format("std::vector<{}>{{ {}, {} + {} }}, ", argToC(m.arrType), m.name, m.name, m.name + "_len");
+                cstr += std::format("std::vector<{}>{{ {}, {} + {} }}, ", arrElemToC(m), m.name, m.name, m.name + "_len");
             else {
                 if (noNames)
                     cstr += std::format("{}, ", argToC(m));
                 else
                     cstr += std::format("{} {}, ", argToC(m), m.name);
             }
+        } else if (m.magic == Hyprwire::HW_MESSAGE_MAGIC_TYPE_OBJECT_ID && pureC) {
+            if (noTypes)
+                cstr += std::format("{} ? {}->getObject().get() : nullptr, ", m.name, m.name);
+            else
+                cstr += noNames ? "Hyprwire::IObject*, " : std::format("Hyprwire::IObject* {}, ", m.name);
+        } else if (m.magic == Hyprwire::HW_MESSAGE_MAGIC_TYPE_OBJECT_ID && unC && noTypes) {
+            cstr += objectFromIObject(m) + ", ";
         } else {
             if (noTypes)
                 cstr += std::format("{}, ", m.name);
@@ -196,6 +291,244 @@ static std::string argsToC(const std::vector<SRequestArgument>& args, bool noNam
     return cstr;
 }
 
+// element type of an array in --views mode
+static std::string arrElemToView(const SRequestArgument& arg) {
+    if (arg.arrType == Hyprwire::HW_MESSAGE_MAGIC_TYPE_VARCHAR)
+        return "std::string_view";
+    return arrElemToC(arg);
+}
+
+// listener-side type in --views mode: points into the receive buffer, valid during the callback
+static std::string argToView(const SRequestArgument& arg) {
+    switch (arg.magic) {
+        case Hyprwire::HW_MESSAGE_MAGIC_TYPE_VARCHAR: return "std::string_view";
+        case Hyprwire::HW_MESSAGE_MAGIC_TYPE_ARRAY: return "std::span<const " + arrElemToView(arg) + ">";
+        default: return argToC(arg);
+    }
+}
+
+// locals of a batch collector, read from the slots the library decoded a call into. Varchars come as views, see IObject::listenBatch.
+static std::string batchSlotsToLocals(const std::vector<SRequestArgument>& args) {
+    std::string str;
+    size_t      slot = 0;
+    for (const auto& m : args) {
+        switch (m.magic) {
+            case Hyprwire::HW_MESSAGE_MAGIC_TYPE_VARCHAR:
+                str += std::format("    const auto {} = *rc<const char**>(args[{}]);\n    const auto {}_len = *rc<uint32_t*>(args[{}]);\n", m.name, slot, m.name, slot + 1);
+                slot += 2;
+                break;
+            case Hyprwire::HW_MESSAGE_MAGIC_TYPE_ARRAY:
+                str += std::format("    const auto {} = *rc<const {}**>(args[{}]);\n    const auto {}_len = *rc<uint32_t*>(args[{}]);\n", m.name, arrElemToView(m), slot, m.name,
+                                   slot + 1);
+                slot += 2;
+                break;
+            case Hyprwire::HW_MESSAGE_MAGIC_TYPE_OBJECT_ID: str += std::format("    const auto {} = *rc<Hyprwire::IObject**>(args[{}]);\n", m.name, slot++); break;
+            default: str += std::format("    const auto {} = *rc<{}*>(args[{}]);\n", m.name, argToC(m), slot++); break;
+        }
+    }
+
+    return str;
+}
+
+// batchSlotsToLocals() converted to argsToTuple()
+static std::string argsToStorage(const std::vector<SRequestArgument>& args) {
+    std::string cstr;
+    for (const auto& m : args) {
+        if (m.arrType != Hyprwire::HW_MESSAGE_MAGIC_END)
+            cstr += std::format("{}{{ {}, {} + {} }}, ", argToStorage(m), m.name, m.name, m.name + "_len");
+        else if (m.magic == Hyprwire::HW_MESSAGE_MAGIC_TYPE_VARCHAR)
+            cstr += std::format("std::string{{ {}, {} }}, ", m.name, m.name + "_len");
+        else if (m.magic == Hyprwire::HW_MESSAGE_MAGIC_TYPE_OBJECT_ID)
+            cstr += objectFromIObject(m) + ", ";
+        else
+            cstr += std::format("{}, ", m.name);
+    }
+
+    if (!cstr.empty())
+        cstr = cstr.substr(0, cstr.size() - 2);
+
+    return cstr;
+}
+
+// args of a listener std::function
+static std::string listenerArgsToC(const std::vector<SRequestArgument>& args, bool noNames = false, bool addSequence = false) {
+    if (!viewArgs)
+        return argsToC(args, noNames, false, addSequence);
+
+    std::string cstr = addSequence ? (noNames ? "uint32_t, " : "uint32_t seq, ") : "";
+    for (const auto& m : args) {
+        cstr += noNames ? std::format("{}, ", argToView(m)) : std::format("{} {}, ", argToView(m), m.name);
+    }
+
+    if (!cstr.empty())
+        cstr = cstr.substr(0, cstr.size() - 2);
+
+    return cstr;
+}
+
+// params of the function the library calls. In --views mode varchars come with their length.
+static std::string trampolineArgsToC(const std::vector<SRequestArgument>& args, bool addSequence = false) {
+    if (!viewArgs)
+        return argsToC(args, false, false, addSequence, true);
+
+    std::string cstr = addSequence ? "uint32_t seq, " : "";
+    for (const auto& m : args) {
+        if (m.magic == Hyprwire::HW_MESSAGE_MAGIC_TYPE_VARCHAR)
+            cstr += std::format("const char* {}, uint32_t {}, ", m.name, m.name + "_len");
+        else if (m.magic == Hyprwire::HW_MESSAGE_MAGIC_TYPE_ARRAY)
+            cstr += std::format("const {}* {}, uint32_t {}, ", arrElemToView(m), m.name, m.name + "_len");
+        else if (m.magic == Hyprwire::HW_MESSAGE_MAGIC_TYPE_OBJECT_ID)
+            cstr += std::format("Hyprwire::IObject* {}, ", m.name);
+        else
+            cstr += std::format("{} {}, ", argToC(m), m.name);
+    }
+
+    if (!cstr.empty())
+        cstr = cstr.substr(0, cstr.size() - 2);
+
+    return cstr;
+}
+
+// trampolineArgsToC() converted to listenerArgsToC()
+static std::string trampolineCallArgs(const std::vector<SRequestArgument>& args, bool addSequence = false) {
+    if (!viewArgs)
+        return argsToC(args, false, true, addSequence, false, true);
+
+    std::string cstr = addSequence ? "seq, " : "";
+    for (const auto& m : args) {
+        if (m.magic == Hyprwire::HW_MESSAGE_MAGIC_TYPE_VARCHAR || m.magic == Hyprwire::HW_MESSAGE_MAGIC_TYPE_ARRAY)
+            cstr += std::format("{}{{ {}, {} }}, ", argToView(m), m.name, m.name + "_len");
+        else if (m.magic == Hyprwire::HW_MESSAGE_MAGIC_TYPE_OBJECT_ID)
+            cstr += objectFromIObject(m) + ", ";
+        else
+            cstr += std::format("{}, ", m.name);
+    }
+
+    if (!cstr.empty())
+        cstr = cstr.substr(0, cstr.size() - 2);
+
+    return cstr;
+}
+
+static const SStructSpec* structFor(const SRequestArgument& arg) {
+    auto it = std::ranges::find_if(STRUCT_SPECS, [&arg](const auto& s) { return s.cType == arg.structType; });
+    return it == STRUCT_SPECS.end() ? nullptr : &*it;
+}
+
+// "array struct:<name>"
+static bool resolveStruct(SRequestArgument& arg, const std::string_view& type) {
+    const auto NAME = type.substr(std::string_view{"array struct:"}.size());
+    auto       it   = std::ranges::find_if(STRUCT_SPECS, [&NAME](const auto& s) { return s.name == NAME; });
+    if (it == STRUCT_SPECS.end()) {
+        std::cerr << "arg " << arg.name << ": no struct named " << NAME << "\n";
+        return false;
+    }
+
+    arg.structType = it->cType;
+    return true;
+}
+
+// encoding="varint|delta-varint|rle", for integer arrays
+static bool resolveEncoding(SRequestArgument& arg, const std::string_view& encoding) {
+    if (encoding.empty())
+        return true;
+
+    if (arg.arrType != Hyprwire::HW_MESSAGE_MAGIC_TYPE_UINT && arg.arrType != Hyprwire::HW_MESSAGE_MAGIC_TYPE_INT && arg.arrType != Hyprwire::HW_MESSAGE_MAGIC_TYPE_U64 &&
+        arg.arrType != Hyprwire::HW_MESSAGE_MAGIC_TYPE_I64) {
+        std::cerr << "arg " << arg.name << ": only arrays of uint, int, u64 or i64 can have an encoding\n";
+        return false;
+    }
+
+    if (encoding == "varint")
+        arg.encoding = Hyprwire::HW_ARRAY_ENCODING_VARINT;
+    else if (encoding == "delta-varint")
+        arg.encoding = Hyprwire::HW_ARRAY_ENCODING_DELTA_VARINT;
+    else if (encoding == "rle")
+        arg.encoding = Hyprwire::HW_ARRAY_ENCODING_RLE;
+    else {
+        std::cerr << "arg " << arg.name << ": unknown encoding " << encoding << "\n";
+        return false;
+    }
+
+    return true;
+}
+
+static std::string encodingToString(Hyprwire::eArrayEncoding e) {
+    switch (e) {
+        case Hyprwire::HW_ARRAY_ENCODING_VARINT: return "Hyprwire::HW_ARRAY_ENCODING_VARINT";
+        case Hyprwire::HW_ARRAY_ENCODING_DELTA_VARINT: return "Hyprwire::HW_ARRAY_ENCODING_DELTA_VARINT";
+        case Hyprwire::HW_ARRAY_ENCODING_RLE: return "Hyprwire::HW_ARRAY_ENCODING_RLE";
+        default: return "Hyprwire::HW_ARRAY_ENCODING_NONE";
+    }
+}
+
+// fd args with cache="true"
+static bool resolveCache(SRequestArgument& arg, bool cache) {
+    if (!cache)
+        return true;
+
+    if (arg.magic != Hyprwire::HW_MESSAGE_MAGIC_TYPE_FD) {
+        std::cerr << "arg " << arg.name << ": only fds can be cached\n";
+        return false;
+    }
+
+    arg.cached = true;
+    return true;
+}
+
+// one arg of SMethod::params
+static std::string paramStr(const SRequestArgument& p) {
+    if (p.cached)
+        return "Hyprwire::HW_MESSAGE_MAGIC_TYPE_CACHED_FD";
+    if (p.encoding != Hyprwire::HW_ARRAY_ENCODING_NONE)
+        return std::format("Hyprwire::HW_MESSAGE_MAGIC_TYPE_ARRAY, Hyprwire::HW_MESSAGE_MAGIC_TYPE_PACKED, {}, {}", magicToString(p.arrType), encodingToString(p.encoding));
+    if (p.arrType == Hyprwire::HW_MESSAGE_MAGIC_TYPE_STRUCT)
+        return std::format("{}, {}", magicToString(p.magic, p.arrType), structFor(p)->fields.size() * 4);
+    return magicToString(p.magic, p.arrType);
+}
+
+static bool checkObjectArgs(const SMethodSpec& m) {
+    for (const auto& a : m.args) {
+        if (a.arrType == Hyprwire::HW_MESSAGE_MAGIC_TYPE_OBJECT_ID) {
+            std::cerr << "method " << m.name << ": arrays of objects aren't supported\n";
+            return false;
+        }
+
+        if (a.magic != Hyprwire::HW_MESSAGE_MAGIC_TYPE_OBJECT_ID)
+            continue;
+
+        if (std::ranges::none_of(OBJECT_SPECS, [&a](const auto& o) { return o.name == a.interface; })) {
+            std::cerr << "method " << m.name << ": arg " << a.name << " has no object interface, got \"" << a.interface << "\"\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// SMethod::objectTypes
+static std::string objectTypesStr(const SMethodSpec& m) {
+    std::string str;
+    for (const auto& a : m.args) {
+        if (a.magic == Hyprwire::HW_MESSAGE_MAGIC_TYPE_OBJECT_ID)
+            str += std::format("\"{}\", ", a.interface);
+    }
+
+    if (!str.empty())
+        str = str.substr(0, str.size() - 2);
+
+    return str;
+}
+
+// calls that create objects can't be batched, and neither can ones with cached fds: ones that come as plain fds are closed after the call
+static bool canBatch(const SMethodSpec& m) {
+    return m.returns.empty() && std::ranges::none_of(m.args, [](const auto& a) { return a.cached; });
+}
+
+static bool hasObjectArgs(const SMethodSpec& m) {
+    return std::ranges::any_of(m.args, [](const auto& a) { return a.magic == Hyprwire::HW_MESSAGE_MAGIC_TYPE_OBJECT_ID; });
+}
+
 static bool scanProtocol(const pugi::xml_document& doc) {
 
     for (const auto& c : doc.child("protocol").children()) {
@@ -215,6 +548,35 @@ static bool scanProtocol(const pugi::xml_document& doc) {
         ENUM_SPECS.emplace_back(std::move(spec));
     }
 
+    for (const auto& c : doc.child("protocol").children()) {
+        if (c.name() != std::string_view{"struct"})
+            continue;
+
+        SStructSpec spec;
+        spec.name  = c.attribute("name").as_string();
+        spec.cType = "S" + capitalize(camelize(PROTO_DATA.nameOriginal + "_" + spec.name));
+
+        for (const auto& f : c.children()) {
+            if (f.name() != std::string_view{"field"})
+                continue;
+
+            const auto TYPE = strToMagic(f.attribute("type").as_string());
+            if (TYPE != Hyprwire::HW_MESSAGE_MAGIC_TYPE_UINT && TYPE != Hyprwire::HW_MESSAGE_MAGIC_TYPE_INT && TYPE != Hyprwire::HW_MESSAGE_MAGIC_TYPE_F32) {
+                std::cerr << "struct " << spec.name << ": field " << f.attribute("name").as_string() << " has to be uint, int or f32\n";
+                return false;
+            }
+
+            spec.fields.emplace_back(f.attribute("name").as_string(), TYPE);
+        }
+
+        if (spec.fields.empty() || spec.fields.size() * 4 > 255) {
+            std::cerr << "struct " << spec.name << ": needs between 1 and 63 fields\n";
+            return false;
+        }
+
+        STRUCT_SPECS.emplace_back(std::move(spec));
+    }
+
     for (const auto& c : doc.child("protocol").children()) {
         if (c.name() != std::string_view{"object"})
             continue;
@@ -233,20 +595,27 @@ static bool scanProtocol(const pugi::xml_document& doc) {
                 continue;
 
             SMethodSpec method;
-            method.name       = m.attribute("name").as_string();
-            method.destructor = m.attribute("destructor").as_bool();
-            method.since      = m.attribute("since").as_int();
-            method.idx        = currentIdx++;
+            method.name         = m.attribute("name").as_string();
+            method.destructor   = m.attribute("destructor").as_bool();
+            method.since        = m.attribute("since").as_int();
+            method.coalesce     = m.attribute("coalesce").as_string() == std::string_view{"latest"};
+            method.highPriority = m.attribute("priority").as_string() == std::string_view{"high"};
+            method.idx          = currentIdx++;
 
             for (const auto& param : m.children()) {
                 if (param.name() == std::string_view{"arg"}) {
                     auto& a = method.args.emplace_back(SRequestArgument{
                         .magic     = strToMagic(param.attribute("type").as_string()),
+                        .interface = param.attribute("interface").as_string(""),
                         .name      = param.attribute("name").as_string(),
                         .allowNull = param.attribute("allow_null").as_bool(),
                     });
                     if (a.magic == Hyprwire::HW_MESSAGE_MAGIC_TYPE_ARRAY)
                         a.arrType = strToMagic(std::string{param.attribute("type").as_string()}.substr(6));
+                    if (a.arrType == Hyprwire::HW_MESSAGE_MAGIC_TYPE_STRUCT && !resolveStruct(a, param.attribute("type").as_string()))
+                        return false;
+                    if (!resolveEncoding(a, param.attribute("encoding").as_string()) || !resolveCache(a, param.attribute("cache").as_bool()))
+                        return false;
                 }
 
                 if (param.name() == std::string_view{"returns"}) {
@@ -255,6 +624,12 @@ static bool scanProtocol(const pugi::xml_document& doc) {
                 }
             }
 
+            // a replaced event would leave its stream's data without a listener
+            if (method.coalesce && std::ranges::any_of(method.args, [](const auto& a) { return a.magic == Hyprwire::HW_MESSAGE_MAGIC_TYPE_STREAM; })) {
+                std::cerr << "s2c " << method.name << ": stream args can't be coalesced\n";
+                return false;
+            }
+
             spec.s2c.emplace_back(std::move(method));
         }
 
@@ -281,6 +656,10 @@ static bool scanProtocol(const pugi::xml_document& doc) {
                     });
                     if (a.magic == Hyprwire::HW_MESSAGE_MAGIC_TYPE_ARRAY)
                         a.arrType = strToMagic(std::string{param.attribute("type").as_string()}.substr(6));
+                    if (a.arrType == Hyprwire::HW_MESSAGE_MAGIC_TYPE_STRUCT && !resolveStruct(a, param.attribute("type").as_string()))
+                        return false;
+                    if (!resolveEncoding(a, param.attribute("encoding").as_string()) || !resolveCache(a, param.attribute("cache").as_bool()))
+                        return false;
                     continue;
                 }
 
@@ -296,6 +675,18 @@ static bool scanProtocol(const pugi::xml_document& doc) {
         OBJECT_SPECS.emplace_back(std::move(spec));
     }
 
+    // objects may refer to ones declared after them
+    for (const auto& o : OBJECT_SPECS) {
+        for (const auto& m : o.c2s) {
+            if (!checkObjectArgs(m))
+                return false;
+        }
+        for (const auto& m : o.s2c) {
+            if (!checkObjectArgs(m))
+                return false;
+        }
+    }
+
     return true;
 }
 
@@ -323,6 +714,19 @@ enum {} : uint32_t {{
         HEADER_PROTOCOL += "};\n";
     }
 
+    // begin structs, packed 4-byte fields, as they are on the wire
+
+    for (const auto& STRUCT : STRUCT_SPECS) {
+        HEADER_PROTOCOL += std::format(R"#(
+struct {} {{
+)#",
+                                       STRUCT.cType);
+        for (const auto& [name, type] : STRUCT.fields) {
+            HEADER_PROTOCOL += std::format("\t{} {} = 0;\n", argToC(type), name);
+        }
+        HEADER_PROTOCOL += std::format("}};\nstatic_assert(sizeof({}) == {});\n", STRUCT.cType, STRUCT.fields.size() * 4);
+    }
+
     // begin objects
 
     for (const auto& object : OBJECT_SPECS) {
@@ -347,7 +751,7 @@ class C{}Spec : public Hyprwire::IProtocolObjectSpec {{
 
             std::string argArrayStr;
             for (const auto& p : m.args) {
-                argArrayStr += magicToString(p.magic, p.arrType) + ", ";
+                argArrayStr += paramStr(p) + ", ";
             }
 
             if (!argArrayStr.empty())
@@ -359,8 +763,10 @@ Hyprwire::SMethod{{
 .params = {{ {} }},
 .returnsType = "{}",
 .since = {},
+.fixedSize = {},
+.objectTypes = {{ {} }},
 }},)#",
-                                           m.idx, argArrayStr, m.returns, m.since);
+                                           m.idx, argArrayStr, m.returns, m.since, fixedWireSize(m), objectTypesStr(m));
         }
 
         if (!object.c2s.empty())
@@ -380,7 +786,7 @@ Hyprwire::SMethod{{
 
             std::string argArrayStr;
             for (const auto& p : m.args) {
-                argArrayStr += magicToString(p.magic, p.arrType) + ", ";
+                argArrayStr += paramStr(p) + ", ";
             }
 
             if (!argArrayStr.empty())
@@ -391,8 +797,13 @@ Hyprwire::SMethod{{
 .idx = {},
 .params = {{ {} }},
 .since = {},
+.coalesce = {},
+.priority = {},
+.fixedSize = {},
+.objectTypes = {{ {} }},
 }},)#",
-                                           m.idx, argArrayStr, m.since);
+                                           m.idx, argArrayStr, m.since, m.coalesce ? "Hyprwire::HW_METHOD_COALESCE_LATEST" : "Hyprwire::HW_METHOD_COALESCE_NONE",
+                                           m.highPriority ? "Hyprwire::HW_METHOD_PRIORITY_HIGH" : "Hyprwire::HW_METHOD_PRIORITY_NORMAL", fixedWireSize(m), objectTypesStr(m));
         }
 
         if (!object.s2c.empty())
@@ -445,15 +856,93 @@ class C{}ProtocolSpec : public Hyprwire::IProtocolSpec {{
     return true;
 }
 
+// batch setters of an object, see canBatch
+static std::string batchSettersHeader(const std::vector<SMethodSpec>& methods) {
+    std::string str;
+    for (const auto& m : methods) {
+        if (!canBatch(m))
+            continue;
+
+        str += std::format(R"#(
+    void set{}Batch(std::function<void(std::span<const {}>)>&& fn);
+            )#",
+                           capitalize(camelize(m.name)), argsToTuple(m.args));
+    }
+
+    return str;
+}
+
+static std::string batchStorageHeader(const std::vector<SMethodSpec>& methods) {
+    std::string str = R"#(
+        struct {
+)#";
+
+    for (const auto& m : methods) {
+        if (!canBatch(m))
+            continue;
+
+        str += std::format(R"#( std::function<void(std::span<const {}>)> {};
+ std::vector<{}> {}Calls;
+)#",
+                           argsToTuple(m.args), m.name, argsToTuple(m.args), m.name);
+    }
+
+    return str + R"#( } m_batches;
+)#";
+}
+
+// collects one call straight from the decoded slots, and hands the run over once it ends
+static std::string batchCollectorSource(const std::string& objectClass, const std::string& nameCamel, const SMethodSpec& m) {
+    return std::format(R"#(
+static void {}_method{}Batch(Hyprwire::IObject* r, void**{}) {{
+{}    rc<{}*>(r->getData())->m_batches.{}Calls.emplace_back({});
+}}
+
+static void {}_method{}BatchDone(Hyprwire::IObject* r) {{
+    auto& batches = rc<{}*>(r->getData())->m_batches;
+    auto  calls   = std::move(batches.{}Calls);
+    batches.{}Calls.clear();
+    if (batches.{})
+        batches.{}(calls);
+}}
+)#",
+                       nameCamel, m.idx, m.args.empty() ? "" : " args", batchSlotsToLocals(m.args), objectClass, m.name, argsToStorage(m.args), nameCamel, m.idx, objectClass,
+                       m.name, m.name, m.name, m.name);
+}
+
+// client objects only listen to events someone set a listener for, see EVENT_INTEREST
+static std::string batchSetterSource(const std::string& objectClass, const std::string& nameCamel, const SMethodSpec& m, bool client) {
+    return std::format(R"#(
+void {}::set{}Batch(std::function<void(std::span<const {}>)>&& fn) {{
+    m_batches.{} = std::move(fn);
+    if (m_batches.{})
+        m_object->listenBatch({}, rc<void*>(::{}_method{}Batch), rc<void*>(::{}_method{}BatchDone));
+    else
+        m_object->listen({}, {}rc<void*>(::{}_method{}){});
+}}
+)#",
+                       objectClass, capitalize(camelize(m.name)), argsToTuple(m.args), m.name, m.name, m.idx, nameCamel, m.idx, nameCamel, m.idx, m.idx,
+                       client ? std::format("m_listeners.{} ? ", m.name) : "", nameCamel, m.idx, client ? " : nullptr" : "");
+}
+
 static bool generateClientCodeHeader(const pugi::xml_document& doc) {
     HEADER_IMPL += std::format(R"#(
 #pragma once
 
 #include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
 #include "{}-spec.hpp"
     )#",
                                PROTO_DATA.nameOriginal);
 
+    // object args may refer to any of them
+    for (const auto& o : OBJECT_SPECS) {
+        HEADER_IMPL += std::format("\nclass CC{}Object;", capitalize(o.nameCamel));
+    }
+
     for (const auto& o : OBJECT_SPECS) {
         HEADER_IMPL += std::format(R"#(
 class CC{}Object {{
@@ -480,19 +969,26 @@ class CC{}Object {{
             HEADER_IMPL += std::format(R"#(
     void set{}(std::function<void({})>&& fn);
             )#",
-                                       capitalize(camelize(m.name)), argsToC(m.args, true));
+                                       capitalize(camelize(m.name)), listenerArgsToC(m.args, true));
         }
 
+        // a run of consecutive events within one read is delivered at once, see canBatch
+        HEADER_IMPL += batchSettersHeader(o.s2c);
+
         HEADER_IMPL += "\n  private:\n\tstruct {\n";
 
         for (const auto& m : o.s2c) {
             HEADER_IMPL += std::format(R"#( std::function<void({})> {};
 )#",
-                                       argsToC(m.args, true), m.name);
+                                       listenerArgsToC(m.args, true), m.name);
         }
 
         HEADER_IMPL += R"#( } m_listeners;
-        
+)#";
+
+        HEADER_IMPL += batchStorageHeader(o.s2c);
+
+        HEADER_IMPL += R"#(        
     Hyprutils::Memory::CWeakPointer<Hyprwire::IObject> m_object;
 };
 )#";
@@ -537,21 +1033,27 @@ static void {}_method{}(Hyprwire::IObject* r{}) {{
         fn({});
 }}
 )#",
-                                  o.nameCamel, m.idx, m.args.empty() ? "" : ", " + argsToC(m.args, false, false, false, true), std::format("CC{}Object", capitalize(o.nameCamel)),
-                                  m.name, argsToC(m.args, false, true, false, false, true));
+                                  o.nameCamel, m.idx, m.args.empty() ? "" : ", " + trampolineArgsToC(m.args), std::format("CC{}Object", capitalize(o.nameCamel)), m.name,
+                                  trampolineCallArgs(m.args));
+
+            if (!canBatch(m))
+                continue;
+
+            SOURCE += batchCollectorSource(std::format("CC{}Object", capitalize(o.nameCamel)), o.nameCamel, m);
         }
 
+        // s2c listeners are registered by set*, so the library knows which events we care about
         SOURCE += std::format(R"#(
 CC{}Object::CC{}Object(Hyprutils::Memory::CSharedPointer<Hyprwire::IObject>&& object) : m_object(std::move(object)) {{
     m_object->setData(this);
             )#",
                               capitalize(o.nameCamel), capitalize(o.nameCamel));
 
-        for (const auto& m : o.s2c) {
-            SOURCE += std::format(R"#(
-    m_object->listen({}, rc<void*>(::{}_method{}));)#",
-                                  m.idx, o.nameCamel, m.idx);
-        }
+        if (viewArgs)
+            SOURCE += "\n    m_object->setArgViews(true);";
+
+        if (strictUtf8)
+            SOURCE += "\n    m_object->setStrictUtf8(true);";
 
         SOURCE += std::format(R"#(
 }}
@@ -587,9 +1089,15 @@ SP<Hyprwire::IObject> CC{}Object::send{}({}) {{
             SOURCE += std::format(R"#(
 void CC{}Object::set{}(std::function<void({})>&& fn) {{
     m_listeners.{} = std::move(fn);
+    m_object->listen({}, m_listeners.{} ? rc<void*>(::{}_method{}) : nullptr);
 }}
 )#",
-                                  capitalize(o.nameCamel), capitalize(camelize(m.name)), argsToC(m.args, true), m.name);
+                                  capitalize(o.nameCamel), capitalize(camelize(m.name)), listenerArgsToC(m.args, true), m.name, m.idx, m.name, o.nameCamel, m.idx);
+
+            if (!canBatch(m))
+                continue;
+
+            SOURCE += batchSetterSource(std::format("CC{}Object", capitalize(o.nameCamel)), o.nameCamel, m, true);
         }
     }
 
@@ -630,10 +1138,19 @@ static bool generateServerCodeHeader(const pugi::xml_document& doc) {
 #pragma once
 
 #include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
 #include "{}-spec.hpp"
     )#",
                                PROTO_DATA.nameOriginal);
 
+    // object args may refer to any of them
+    for (const auto& o : OBJECT_SPECS) {
+        HEADER_IMPL += std::format("\nclass C{}Object;", capitalize(o.nameCamel));
+    }
+
     for (const auto& o : OBJECT_SPECS) {
         HEADER_IMPL += std::format(R"#(
 class C{}Object {{
@@ -666,23 +1183,41 @@ class C{}Object {{
                                        capitalize(camelize(m.name)), argsToC(m.args));
         }
 
+        for (const auto& m : o.s2c) {
+            // object ids are per client
+            if (hasObjectArgs(m))
+                continue;
+
+            HEADER_IMPL += std::format(R"#(
+    static void broadcast{}(const std::vector<Hyprutils::Memory::CSharedPointer<C{}Object>>& targets{});
+            )#",
+                                       capitalize(camelize(m.name)), capitalize(o.nameCamel), m.args.empty() ? "" : ", " + argsToC(m.args));
+        }
+
         for (const auto& m : o.c2s) {
             HEADER_IMPL += std::format(R"#(
     void set{}(std::function<void({})>&& fn);
             )#",
-                                       capitalize(camelize(m.name)), argsToC(m.args, true, false, !m.returns.empty()));
+                                       capitalize(camelize(m.name)), listenerArgsToC(m.args, true, !m.returns.empty()));
         }
 
+        // a run of consecutive calls within one read is delivered at once, see canBatch
+        HEADER_IMPL += batchSettersHeader(o.c2s);
+
         HEADER_IMPL += "\n  private:\n\tstruct {\n";
 
         for (const auto& m : o.c2s) {
             HEADER_IMPL += std::format(R"#( std::function<void({})> {};
 )#",
-                                       argsToC(m.args, true, false, !m.returns.empty()), m.name);
+                                       listenerArgsToC(m.args, true, !m.returns.empty()), m.name);
         }
 
         HEADER_IMPL += R"#( } m_listeners;
-        
+)#";
+
+        HEADER_IMPL += batchStorageHeader(o.c2s);
+
+        HEADER_IMPL += R"#(        
     Hyprutils::Memory::CWeakPointer<Hyprwire::IObject> m_object;
 };
 )#";
@@ -728,8 +1263,13 @@ static void {}_method{}(Hyprwire::IObject* r{}) {{
         fn({});
 }}
 )#",
-                                  o.nameCamel, m.idx, m.args.empty() && m.returns.empty() ? "" : ", " + argsToC(m.args, false, false, !m.returns.empty(), true),
-                                  std::format("C{}Object", capitalize(o.nameCamel)), m.name, argsToC(m.args, false, true, !m.returns.empty(), false, true));
+                                  o.nameCamel, m.idx, m.args.empty() && m.returns.empty() ? "" : ", " + trampolineArgsToC(m.args, !m.returns.empty()),
+                                  std::format("C{}Object", capitalize(o.nameCamel)), m.name, trampolineCallArgs(m.args, !m.returns.empty()));
+
+            if (!canBatch(m))
+                continue;
+
+            SOURCE += batchCollectorSource(std::format("C{}Object", capitalize(o.nameCamel)), o.nameCamel, m);
         }
 
         SOURCE += std::format(R"#(
@@ -738,6 +1278,12 @@ C{}Object::C{}Object(Hyprutils::Memory::CSharedPointer<Hyprwire::IObject>&& obje
             )#",
                               capitalize(o.nameCamel), capitalize(o.nameCamel));
 
+        if (viewArgs)
+            SOURCE += "\n    m_object->setArgViews(true);";
+
+        if (strictUtf8)
+            SOURCE += "\n    m_object->setStrictUtf8(true);";
+
         for (const auto& m : o.c2s) {
             SOURCE += std::format(R"#(
     m_object->listen({}, rc<void*>(::{}_method{}));)#",
@@ -762,13 +1308,44 @@ void C{}Object::send{}({}) {{
                             capitalize(o.nameCamel), capitalize(camelize(m.name)), argsToC(m.args), m.idx, m.args.empty() ? "" : ", " + argsToC(m.args, false, true, false, true));
         }
 
+        for (const auto& m : o.s2c) {
+            if (hasObjectArgs(m))
+                continue;
+
+            SOURCE += std::format(R"#(
+void C{}Object::broadcast{}(const std::vector<SP<C{}Object>>& targets{}) {{
+    std::vector<SP<Hyprwire::IObject>> objects;
+    objects.reserve(targets.size());
+    for (const auto& t : targets) {{
+        if (t && t->m_object)
+            objects.emplace_back(t->m_object.lock());
+    }}
+
+    if (objects.empty())
+        return;
+
+    if (auto sock = objects.front()->serverSock(); sock)
+        sock->broadcast(objects, {}{});
+}}
+)#",
+                                  capitalize(o.nameCamel), capitalize(camelize(m.name)), capitalize(o.nameCamel), m.args.empty() ? "" : ", " + argsToC(m.args), m.idx,
+                                  m.args.empty() ? "" : ", " + argsToC(m.args, false, true, false, true));
+        }
+
         for (const auto& m : o.c2s) {
             SOURCE += std::format(R"#(
 void C{}Object::set{}(std::function<void({})>&& fn) {{
     m_listeners.{} = std::move(fn);
+    m_object->listen({}, rc<void*>(::{}_method{}));
 }}
 )#",
-                                  capitalize(o.nameCamel), capitalize(camelize(m.name)), argsToC(m.args, true, false, !m.returns.empty()), m.name);
+                                  capitalize(o.nameCamel), capitalize(camelize(m.name)), listenerArgsToC(m.args, true, !m.returns.empty()), m.name, m.idx, o.nameCamel,
+                                  m.idx);
+
+            if (!canBatch(m))
+                continue;
+
+            SOURCE += batchSetterSource(std::format("C{}Object", capitalize(o.nameCamel)), o.nameCamel, m, false);
         }
     }
 
@@ -837,6 +1414,16 @@ int main(int argc, char** argv, char** envp) {
             continue;
         }
 
+        if (curarg == "--views") {
+            viewArgs = true;
+            continue;
+        }
+
+        if (curarg == "--strict-utf8") {
+            strictUtf8 = true;
+            continue;
+        }
+
         if (pathsTaken == 0) {
             protopath = curarg;
             pathsTaken++;
@@ -873,7 +1460,9 @@ int main(int argc, char** argv, char** envp) {
         std::format("// Generated with hyprwire-scanner {}. Made with vaxry's keyboard and ❤️.\n// {}\n\n/*\n This protocol's authors' copyright notice is:\n\n{}\n*/\n\n",
                     SCANNER_VERSION, PROTO_DATA.nameOriginal, std::string{doc.child("protocol").child("copyright").child_value()});
 
-    scanProtocol(doc);
+    if (!scanProtocol(doc))
+        return 1;
+
     generateProtocolHeader(doc);
     if (clientCode) {
         generateClientCodeHeader(doc);
@@ -3,6 +3,7 @@
 #include "../../helpers/Log.hpp"
 #include "../../helpers/FFI.hpp"
 #include "../../Macros.hpp"
+#include "../../helpers/Defines.hpp"
 #include "../message/MessageType.hpp"
 #include "../message/MessageParser.hpp"
 #include "../message/messages/GenericProtocolMessage.hpp"
@@ -56,3 +57,56 @@ SP<IClientSocket> CClientObject::clientSock() {
         return nullptr;
     return m_client.lock();
 }
+
+void CClientObject::listen(uint32_t id, void* fn) {
+    const bool HAD = m_listeners.size() > id && m_listeners.at(id);
+
+    IWireObject::listen(id, fn);
+
+    if (HAD != !!fn && m_client)
+        m_client->interestChanged(reinterpretPointerCast<CClientObject>(m_self.lock()));
+}
+
+std::vector<uint32_t> CClientObject::interestMask() {
+    std::vector<uint32_t> mask((methodsIn().size() + 31) / 32, 0);
+
+    for (size_t i = 0; i < m_listeners.size() && i < methodsIn().size(); ++i) {
+        if (m_listeners.at(i))
+            mask.at(i / 32) |= (1U << (i % 32));
+    }
+
+    return mask;
+}
+
+bool CClientObject::alignedArrays() {
+    return m_client && (m_client->m_features & HW_PROTOCOL_FEATURE_ALIGNED_ARRAYS);
+}
+
+bool CClientObject::compact() {
+    // calls made before the handshake settled the version are v1, every version reads those
+    return m_client && m_client->m_handshakeDone && m_client->m_version >= HW_PROTOCOL_VER_COMPACT;
+}
+
+CStreamTable* CClientObject::streams() {
+    return m_client ? &m_client->m_streams : nullptr;
+}
+
+CStringTable* CClientObject::strings() {
+    return m_client && (m_client->m_features & HW_PROTOCOL_FEATURE_STRING_TABLE) ? &m_client->m_strings : nullptr;
+}
+
+CFdCache* CClientObject::fdCache() {
+    return m_client && (m_client->m_features & HW_PROTOCOL_FEATURE_FD_CACHE) ? &m_client->m_fdCache : nullptr;
+}
+
+IWireObject* CClientObject::connectionObject(uint32_t id) {
+    if (!m_client)
+        return nullptr;
+
+    const auto IT = m_client->m_objectsById.find(id);
+    return IT == m_client->m_objectsById.end() ? nullptr : IT->second.get();
+}
+
+bool CClientObject::sameConnection(IWireObject* other) {
+    return other->server() == server() && sc<CClientObject*>(other)->m_client.lock() == m_client.lock();
+}
@@ -23,6 +23,16 @@ namespace Hyprwire {
         virtual Hyprutils::Memory::CSharedPointer<IObject>       self();
         virtual Hyprutils::Memory::CSharedPointer<IClientSocket> clientSock();
         virtual bool                                             server();
+        virtual void                                             listen(uint32_t id, void* fn);
+        virtual bool                                             alignedArrays();
+        virtual bool                                             compact();
+        virtual CStreamTable*                                    streams();
+        virtual CStringTable*                                    strings();
+        virtual CFdCache*                                        fdCache();
+        virtual IWireObject*                                     connectionObject(uint32_t id);
+        virtual bool                                             sameConnection(IWireObject* other);
+
+        std::vector<uint32_t>                                    interestMask();
 
         WP<CClientSocket>                                        m_client;
     };
@@ -1,6 +1,7 @@
 #include "ClientSocket.hpp"
 #include "../../helpers/Memory.hpp"
 #include "../../helpers/Log.hpp"
+#include "../../helpers/Defines.hpp"
 #include "../../Macros.hpp"
 #include "../message/MessageParser.hpp"
 #include "../message/messages/IMessage.hpp"
@@ -8,6 +9,7 @@
 #include "../message/messages/BindProtocol.hpp"
 #include "../message/messages/GenericProtocolMessage.hpp"
 #include "../message/messages/RoundtripRequest.hpp"
+#include "../message/messages/EventInterest.hpp"
 #include "../socket/SocketHelpers.hpp"
 #include "../wireObject/IWireObject.hpp"
 #include "ClientObject.hpp"
@@ -20,8 +22,10 @@
 
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <fcntl.h>
 #include <netinet/in.h>
 
+#include <algorithm>
 #include <filesystem>
 #include <hyprutils/utils/ScopeGuard.hpp>
 
@@ -30,22 +34,40 @@ using namespace Hyprutils::OS;
 using namespace Hyprutils::Utils;
 
 SP<IClientSocket> IClientSocket::open(const std::string& path) {
+    return open(path, false);
+}
+
+SP<IClientSocket> IClientSocket::open(const int fd) {
+    return open(fd, false);
+}
+
+SP<IClientSocket> IClientSocket::open(const std::string& path, bool optimistic) {
     SP<CClientSocket> sock = makeShared<CClientSocket>();
     sock->m_self           = sock;
+    sock->m_optimistic     = optimistic;
+    sock->m_corked         = optimistic;
 
     if (!sock->attempt(path))
         return nullptr;
 
+    if (optimistic)
+        sock->startOptimistic(Env::clientMaxVersion());
+
     return sock;
 }
 
-SP<IClientSocket> IClientSocket::open(const int fd) {
+SP<IClientSocket> IClientSocket::open(const int fd, bool optimistic) {
     SP<CClientSocket> sock = makeShared<CClientSocket>();
     sock->m_self           = sock;
+    sock->m_optimistic     = optimistic;
+    sock->m_corked         = optimistic;
 
     if (!sock->attemptFromFd(fd))
         return nullptr;
 
+    if (optimistic)
+        sock->startOptimistic(Env::clientMaxVersion());
+
     return sock;
 }
 
@@ -67,6 +89,8 @@ bool CClientSocket::attempt(const std::string& path) {
         return false;
     }
 
+    m_path = path;
+
     m_fd.setFlags(O_NONBLOCK | O_CLOEXEC);
 
     m_pollfds = {pollfd{
@@ -96,6 +120,101 @@ bool CClientSocket::attemptFromFd(const int fd) {
     return true;
 }
 
+void CClientSocket::startOptimistic(uint32_t version) {
+    // don't wait for HANDSHAKE_BEGIN, ack right after the hello. Everything stays corked until the first dispatch,
+    // so that hello, ack and the binds go out in one write.
+    // The ack itself is made lazily, before the first thing that follows it, so that implementations added after open() make it into the query.
+    m_version        = version;
+    m_handshakeBegin = std::chrono::steady_clock::now();
+    m_ackPending     = true;
+}
+
+CHandshakeAckMessage CClientSocket::makeAck(uint32_t version) {
+    if (version < 2)
+        return CHandshakeAckMessage(version);
+
+    uint32_t features = Env::clientFeatures();
+
+    m_query.clear();
+    for (const auto& impl : m_impls) {
+        m_query.emplace_back(impl->protocol()->specName());
+    }
+
+    // nothing to ask for, get the full list
+    if (m_query.empty())
+        features &= ~HW_PROTOCOL_FEATURE_PROTOCOL_QUERY;
+
+    return CHandshakeAckMessage(version, features, m_query);
+}
+
+void CClientSocket::uncork() {
+    if (m_ackPending) {
+        m_ackPending = false;
+        sendMessage(makeAck(m_version));
+    }
+
+    m_corked = false;
+
+    if (m_corkedData.empty())
+        return;
+
+    auto             data   = std::move(m_corkedData);
+    auto             dupFds = std::move(m_corkedFds);
+    std::vector<int> fds;
+    m_corkedData.clear();
+    m_corkedFds.clear();
+
+    for (const auto& fd : dupFds) {
+        fds.emplace_back(fd.get());
+    }
+
+    sendRaw(data, fds);
+}
+
+bool CClientSocket::reconnectFallback() {
+    const auto VERSION = m_fallbackVersion;
+    m_fallbackVersion  = 0;
+
+    if (m_path.empty()) {
+        Debug::log(ERR, "optimistic handshake failed: server doesn't support version {} and we can't reconnect an fd", m_version);
+        disconnectOnError();
+        return false;
+    }
+
+    Debug::log(WARN, "optimistic handshake: server doesn't support version {}, reconnecting with version {}", m_version, VERSION);
+
+    m_fd.reset();
+    m_corked = true;
+    m_corkedData.clear();
+    m_corkedFds.clear();
+    m_features    = 0;
+    m_partialRead = {};
+
+    if (!attempt(m_path)) {
+        Debug::log(ERR, "optimistic handshake: reconnect failed");
+        disconnectOnError();
+        return false;
+    }
+
+    startOptimistic(VERSION);
+
+    // the server never saw our binds, replay them. Nothing else was sent, calls on those are still deferred.
+    for (const auto& o : m_optimisticBinds) {
+        if (!o)
+            continue;
+
+        sendMessage(CBindProtocolMessage(o->m_protocolName, o->m_seq, o->m_version));
+    }
+
+    // roundtrips requested while corked went down with the old connection
+    for (const auto& [seq, cb] : m_roundtripCallbacks) {
+        if (seq > m_lastAckdRoundtripSeq && !std::ranges::contains(m_deferredRoundtrips, seq))
+            sendMessage(CRoundtripRequestMessage(seq));
+    }
+
+    return true;
+}
+
 void CClientSocket::addImplementation(SP<IProtocolClientImplementation>&& x) {
     m_impls.emplace_back(std::move(x));
 }
@@ -108,6 +227,12 @@ bool CClientSocket::dispatchEvents(bool block) {
     if (m_error)
         return false;
 
+    if (m_corked)
+        uncork();
+
+    // only now: listeners set between creating an object and dispatching still count
+    flushInterest();
+
     if (!m_handshakeDone) {
         const auto MAX_MS =
             std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::milliseconds(HANDSHAKE_MAX_MS) - (std::chrono::steady_clock::now() - m_handshakeBegin)).count();
@@ -122,7 +247,8 @@ bool CClientSocket::dispatchEvents(bool block) {
     if (m_handshakeDone)
         poll(m_pollfds.data(), m_pollfds.size(), block ? -1 : 0);
 
-    if (m_pollfds[0].revents & POLLHUP)
+    // the server may have hung up right after its last messages, a fatal error among them. Read those first.
+    if ((m_pollfds[0].revents & POLLHUP) && !(m_pollfds[0].revents & POLLIN))
         return false;
 
     if (!(m_pollfds[0].revents & POLLIN))
@@ -149,67 +275,96 @@ bool CClientSocket::dispatchEvents(bool block) {
         return false;
     }
 
-    std::erase_if(m_pendingOutgoing, [this](auto& msg) {
-        auto obj = objectForSeq(msg.m_dependsOnSeq);
-        if (!obj)
-            return true;
+    if (m_fallbackVersion)
+        return reconnectFallback();
 
-        auto wObj = reinterpretPointerCast<CClientObject>(obj);
-        if (!wObj->m_id)
-            return false;
-
-        msg.resolveSeq(wObj->m_id);
-        TRACE(Debug::log(TRACE, "[{} @ {:.3f}] -> Handle deferred: {}", m_fd.get(), steadyMillis(), msg.parseData()));
-        sendMessage(msg);
-        return true;
-    });
+    flushResolved();
+    flushRoundtrips();
 
     return !m_error;
 }
 
-void CClientSocket::sendMessage(const IMessage& message) {
-    TRACE(Debug::log(TRACE, "[{} @ {:.3f}] -> {}", m_fd.get(), steadyMillis(), message.parseData()));
+void CClientSocket::deferMessage(uint32_t seq, CGenericProtocolMessage&& msg) {
+    msg.m_dependsOnSeq = seq;
 
-    // NOLINTNEXTLINE
-    msghdr      msg = {0}; // NOLINTNEXTLINE
-    iovec       io  = {0};
+    std::vector<CFileDescriptor> fds;
+    for (auto& fd : msg.m_fds) {
+        fds.emplace_back(fcntl(fd, F_DUPFD_CLOEXEC, 0));
+        fd = fds.back().get();
+    }
+
+    m_pendingOutgoing[seq].emplace_back(SDeferredMessage{.idx = m_deferredIdx++, .msg = std::move(msg), .fds = std::move(fds)});
+}
+
+void CClientSocket::flushResolved() {
+    if (m_resolvedOutgoing.empty())
+        return;
+
+    // onSeq resolves per-seq, restore the order they were called in
+    std::ranges::sort(m_resolvedOutgoing, {}, &SDeferredMessage::idx);
+
+    std::vector<uint8_t> data;
+    std::vector<int>     fds;
+
+    for (const auto& m : m_resolvedOutgoing) {
+        TRACE(Debug::log(TRACE, "[{} @ {:.3f}] -> Handle deferred: {}", m_fd.get(), steadyMillis(), m.msg.parseData()));
+        data.append_range(framed() ? m.msg.framed() : m.msg.m_data);
+        fds.append_range(m.msg.fds());
+    }
 
-    const auto& FDS = message.fds();
+    sendRaw(data, fds);
 
-    // fucking evil!
-    io.iov_base    = cc<void*>(rc<const void*>(message.m_data.data()));
-    io.iov_len     = message.m_data.size();
-    msg.msg_iov    = &io;
-    msg.msg_iovlen = 1;
+    m_resolvedOutgoing.clear();
+}
 
-    std::vector<uint8_t> controlBuf;
+void CClientSocket::sendMessage(const IMessage& message) {
+    if (m_ackPending) {
+        m_ackPending = false;
+        sendMessage(makeAck(m_version));
+    }
 
-    if (!FDS.empty()) {
-        controlBuf.resize(CMSG_SPACE(sizeof(int) * FDS.size()));
+    // calls resolved during this dispatch, and roundtrips that waited on them, were made before this one
+    flushResolved();
+    flushRoundtrips();
 
-        msg.msg_control    = controlBuf.data();
-        msg.msg_controllen = controlBuf.size();
+    TRACE(Debug::log(TRACE, "[{} @ {:.3f}] -> {}", m_fd.get(), steadyMillis(), message.parseData()));
 
-        cmsghdr* cmsg    = CMSG_FIRSTHDR(&msg);
-        cmsg->cmsg_level = SOL_SOCKET;
-        cmsg->cmsg_type  = SCM_RIGHTS;
-        cmsg->cmsg_len   = CMSG_LEN(sizeof(int) * FDS.size());
+    if (framed())
+        sendRaw(message.framed(), message.fds());
+    else
+        sendRaw(message.m_data, message.fds());
+}
 
-        int* data = rc<int*>(CMSG_DATA(cmsg));
-        for (size_t i = 0; i < FDS.size(); ++i) {
-            data[i] = FDS.at(i);
+void CClientSocket::sendRaw(const std::vector<uint8_t>& bytes, const std::vector<int>& fds) {
+    if (m_corked) {
+        m_corkedData.append_range(bytes);
+        for (const auto& fd : fds) {
+            m_corkedFds.emplace_back(fcntl(fd, F_DUPFD_CLOEXEC, 0));
         }
+        return;
     }
 
+    size_t sent = 0;
+
     while (m_fd.isValid()) {
-        int ret = sendmsg(m_fd.get(), &msg, 0);
-        if (ret < 0 && (errno == EWOULDBLOCK || errno == EAGAIN)) {
+        // partial writes can happen with batched writes, sendWithFds picks up the fds that didn't go out yet.
+        // A server that hung up is an error we read about, not a SIGPIPE for the whole app.
+        const auto RET = sendWithFds(m_fd, bytes, sent, fds, MSG_NOSIGNAL);
+        if (RET < 0 && (errno == EWOULDBLOCK || errno == EAGAIN)) {
             pollfd pfd = {
                 .fd     = m_fd.get(),
                 .events = POLLOUT | POLLWRBAND,
             };
             poll(&pfd, 1, -1);
-        } else
+            continue;
+        }
+
+        if (RET <= 0)
+            break;
+
+        sent += RET;
+
+        if (sent >= bytes.size())
             break;
     }
 }
@@ -229,7 +384,55 @@ void CClientSocket::serverSpecs(const std::vector<std::string>& s) {
         disconnectOnError();
     }
 
+    onHandshakeDone();
+}
+
+void CClientSocket::serverSpecsFromQuery(const std::vector<uint32_t>& versions) {
+    if (versions.size() != m_query.size()) {
+        Debug::log(ERR, "fatal: server answered {} protocols to a query of {}", versions.size(), m_query.size());
+        disconnectOnError();
+        return;
+    }
+
+    for (size_t i = 0; i < versions.size(); ++i) {
+        if (!versions.at(i))
+            continue;
+
+        m_serverSpecs.emplace_back(makeShared<CServerSpec>(m_query.at(i), versions.at(i)));
+    }
+
+    onHandshakeDone();
+}
+
+void CClientSocket::onHandshakeDone() {
     m_handshakeDone = true;
+
+    if (m_optimisticBinds.empty())
+        return;
+
+    // check what we bound blindly. The server skips binds it doesn't support, drop those and whatever waits on them.
+    for (const auto& o : m_optimisticBinds) {
+        if (!o)
+            continue;
+
+        const auto SPEC = getSpec(o->m_protocolName);
+        if (SPEC && SPEC->specVer() >= o->m_version)
+            continue;
+
+        Debug::log(ERR, "optimistic bind of {}@{} failed: unsupported by the server", o->m_protocolName, o->m_version);
+        m_pendingOutgoing.erase(o->m_seq);
+        o->m_seq = 0;
+    }
+
+    // with client ids, everything created before the handshake already has its id
+    if (clientIds()) {
+        for (const auto& o : m_objects) {
+            if (!o->m_id && o->m_seq)
+                onSeq(o->m_seq, o->m_seq);
+        }
+    }
+
+    m_optimisticBinds.clear();
 }
 
 bool CClientSocket::waitForHandshake() {
@@ -256,14 +459,53 @@ SP<IProtocolSpec> CClientSocket::getSpec(const std::string& name) {
 }
 
 void CClientSocket::onSeq(uint32_t seq, uint32_t id) {
+    // id 0: the server refused the bind
+    if (!id) {
+        onBindRefused(seq);
+        return;
+    }
+
+    bool found = false;
     for (const auto& c : m_objects) {
         if (c->m_seq == seq) {
-            c->m_id = id;
-            return;
+            setObjectId(c, id);
+            found   = true;
+            break;
+        }
+    }
+
+    if (!found)
+        Debug::log(WARN, "[{} @ {:.3f}] -> No object for sequence {} (Would be id {}).!", m_fd.get(), steadyMillis(), seq, id);
+
+    auto it = m_pendingOutgoing.find(seq);
+    if (it == m_pendingOutgoing.end())
+        return;
+
+    // without an object, there is nobody to send these for
+    if (found) {
+        for (auto& m : it->second) {
+            m.msg.resolveSeq(id);
+            m_resolvedOutgoing.emplace_back(std::move(m));
         }
     }
 
-    Debug::log(WARN, "[{} @ {:.3f}] -> No object for sequence {} (Would be id {}).!", m_fd.get(), steadyMillis(), seq, id);
+    m_pendingOutgoing.erase(it);
+}
+
+void CClientSocket::onBindRefused(uint32_t seq) {
+    m_pendingOutgoing.erase(seq);
+
+    // optimistic binds the server doesn't support were already dropped in onHandshakeDone
+    const auto IT = std::ranges::find_if(m_objects, [seq](const auto& o) { return o->m_seq == seq; });
+    if (IT == m_objects.end())
+        return;
+
+    Debug::log(ERR, "server refused to bind {}@{}", (*IT)->m_protocolName, (*IT)->m_version);
+
+    m_objectsById.erase((*IT)->m_id);
+    (*IT)->m_seq = 0;
+    (*IT)->m_id  = 0;
+    m_objects.erase(IT);
 }
 
 SP<IObject> CClientSocket::bindProtocol(const SP<IProtocolSpec>& spec, uint32_t version) {
@@ -275,16 +517,36 @@ SP<IObject> CClientSocket::bindProtocol(const SP<IProtocolSpec>& spec, uint32_t
 
     auto object            = makeShared<CClientObject>(m_self.lock());
     object->m_spec         = spec->objects().front();
-    object->m_seq          = ++m_seq;
+    object->m_seq          = nextObjectSeq();
     object->m_version      = version;
     object->m_self         = object;
     object->m_protocolName = spec->specName();
     m_objects.emplace_back(object);
 
-    auto bindMessage = CBindProtocolMessage(spec->specName(), object->m_seq, version);
-    sendMessage(bindMessage);
+    // bind by index if we queried for it, saves sending the name again
+    const auto QUERY_IT = m_handshakeDone && (m_features & HW_PROTOCOL_FEATURE_PROTOCOL_QUERY) ? std::ranges::find(m_query, spec->specName()) : m_query.end();
 
-    waitForObject(object);
+    if (QUERY_IT != m_query.end())
+        sendMessage(CBindProtocolMessage(sc<uint32_t>(std::distance(m_query.begin(), QUERY_IT)), object->m_seq, version));
+    else
+        sendMessage(CBindProtocolMessage(spec->specName(), object->m_seq, version));
+
+    interestChanged(object);
+
+    if (m_optimistic && !m_handshakeDone) {
+        // resolved once the handshake is done
+        m_optimisticBinds.emplace_back(object);
+        return object;
+    }
+
+    // with client ids, the seq is the id and the server won't send NEW_OBJECT
+    if (clientIds())
+        setObjectId(object, object->m_seq);
+    else {
+        waitForObject(object);
+        if (!object->m_id)
+            return nullptr;
+    }
 
     return object;
 }
@@ -313,35 +575,134 @@ SP<CClientObject> CClientSocket::makeObject(const std::string& protocolName, con
 
     object->m_seq     = seq;
     object->m_version = 0; // TODO: client version doesn't matter that much, but for verification's sake we could fix this
+
+    if (clientIds())
+        setObjectId(object, seq);
+
     m_objects.emplace_back(object);
+    interestChanged(object);
     return object;
 }
 
+void CClientSocket::interestChanged(SP<CClientObject> object) {
+    if (m_handshakeDone && !(m_features & HW_PROTOCOL_FEATURE_EVENT_INTEREST))
+        return;
+
+    if (std::ranges::find(m_interestDirty, object) == m_interestDirty.end())
+        m_interestDirty.emplace_back(object);
+}
+
+void CClientSocket::flushInterest() {
+    if (m_interestDirty.empty() || !m_handshakeDone)
+        return;
+
+    if (!(m_features & HW_PROTOCOL_FEATURE_EVENT_INTEREST)) {
+        m_interestDirty.clear();
+        return;
+    }
+
+    auto dirty = std::exchange(m_interestDirty, {});
+
+    for (const auto& o : dirty) {
+        if (!o)
+            continue;
+
+        // the server doesn't know the object yet
+        if (!o->m_id) {
+            m_interestDirty.emplace_back(o);
+            continue;
+        }
+
+        sendMessage(CEventInterestMessage(o->m_id, o->interestMask()));
+    }
+}
+
+uint32_t CClientSocket::nextObjectSeq() {
+    // before the handshake we don't know if client ids will be granted, so pick from the client range just in case.
+    // These are valid plain seqs too.
+    const bool CLIENT_RANGE = clientIds() || (m_optimistic && !m_handshakeDone);
+
+    // at most m_objects.size() values are taken, so one of the next m_objects.size() + 1 is free
+    while (true) {
+        ++m_seq;
+
+        // the client range has 2^31 ids, past that the counter comes back to ones that may still be live
+        if (m_seq & HW_CLIENT_ID_BASE)
+            m_seqWrapped = true;
+
+        const uint32_t SEQ = CLIENT_RANGE ? HW_CLIENT_ID_BASE + (m_seq & ~HW_CLIENT_ID_BASE) : m_seq;
+
+        if (SEQ == 0)
+            continue;
+
+        if (!m_seqWrapped || !seqInUse(SEQ))
+            return SEQ;
+    }
+}
+
+bool CClientSocket::seqInUse(uint32_t seq) {
+    return std::ranges::any_of(m_objects, [seq](const auto& o) { return o->m_seq == seq || o->m_id == seq; });
+}
+
+bool CClientSocket::clientIds() {
+    return m_features & HW_PROTOCOL_FEATURE_CLIENT_IDS;
+}
+
+bool CClientSocket::framed() {
+    return m_features & HW_PROTOCOL_FEATURE_FRAMES;
+}
+
 void CClientSocket::waitForObject(SP<IWireObject> x) {
     m_waitingOnObject = x;
-    while (!x->m_id && !m_error) {
+    // a refused bind resets the seq
+    while (!x->m_id && x->m_seq && !m_error) {
         dispatchEvents(true);
     }
     m_waitingOnObject.reset();
 }
 
 void CClientSocket::onGeneric(const CGenericProtocolMessage& msg) {
-    for (const auto& o : m_objects) {
-        if (o->m_id == msg.m_object) {
-            o->called(msg.m_method, msg.m_dataSpan, msg.m_fds);
-            return;
-        }
+    if (m_batch.object && (m_batch.object->m_id != msg.m_object || m_batch.method != msg.m_method))
+        flushBatch();
+
+    if (const auto IT = m_objectsById.find(msg.m_object); IT != m_objectsById.end()) {
+        dispatchCall(IT->second.lock(), msg);
+        return;
     }
 
     Debug::log(WARN, "[{} @ {:.3f}] -> Generic message not handled. No object with id {}!", m_fd.get(), steadyMillis(), msg.m_object);
 }
 
-SP<IObject> CClientSocket::objectForId(uint32_t id) {
-    for (const auto& o : m_objects) {
-        if (o->m_id == id)
-            return o;
+void CClientSocket::dispatchCall(SP<CClientObject> obj, const CGenericProtocolMessage& msg) {
+    obj->called(msg.m_method, msg.m_dataSpan, msg.m_args, msg.m_fds, msg.m_compact);
+
+    if (obj->m_batchDone.size() > msg.m_method && obj->m_batchDone.at(msg.m_method)) {
+        m_batch.object = obj;
+        m_batch.method = msg.m_method;
     }
-    return nullptr;
+}
+
+void CClientSocket::flushBatch() {
+    if (!m_batch.object)
+        return;
+
+    auto obj = m_batch.object.lock();
+    m_batch.object.reset();
+
+    if (obj->m_batchDone.size() <= m_batch.method || !obj->m_batchDone.at(m_batch.method))
+        return;
+
+    rc<void (*)(IObject*)>(obj->m_batchDone.at(m_batch.method))(obj.get());
+}
+
+SP<IObject> CClientSocket::objectForId(uint32_t id) {
+    const auto IT = m_objectsById.find(id);
+    return IT == m_objectsById.end() ? nullptr : SP<IObject>(IT->second.lock());
+}
+
+void CClientSocket::setObjectId(SP<CClientObject> object, uint32_t id) {
+    object->m_id      = id;
+    m_objectsById[id] = object;
 }
 
 SP<IObject> CClientSocket::objectForSeq(uint32_t seq) {
@@ -361,11 +722,69 @@ void CClientSocket::roundtrip() {
     if (m_error)
         return;
 
-    auto nextSeq = ++m_lastSentRoundtripSeq;
-    sendMessage(CRoundtripRequestMessage(nextSeq));
+    bool done = false;
+    roundtripAsync([&done] { done = true; });
+
+    const auto SEQ = m_lastSentRoundtripSeq;
 
-    while (m_lastAckdRoundtripSeq < nextSeq) {
+    while (!done) {
         if (!dispatchEvents(true))
             break;
     }
+
+    // if we bailed, don't leave a dangling ref to done
+    if (!done)
+        std::erase_if(m_roundtripCallbacks, [SEQ](const auto& e) { return e.first == SEQ; });
+}
+
+void CClientSocket::roundtripAsync(std::function<void()>&& callback) {
+    if (m_error)
+        return;
+
+    auto nextSeq = ++m_lastSentRoundtripSeq;
+    m_roundtripCallbacks.emplace_back(nextSeq, std::move(callback));
+
+    // calls waiting for an object id have to reach the server first
+    if (!m_pendingOutgoing.empty() || !m_deferredRoundtrips.empty()) {
+        m_deferredRoundtrips.emplace_back(nextSeq);
+        return;
+    }
+
+    sendMessage(CRoundtripRequestMessage(nextSeq));
+}
+
+void CClientSocket::flushRoundtrips() {
+    if (m_deferredRoundtrips.empty() || !m_pendingOutgoing.empty())
+        return;
+
+    // sendMessage flushes these too
+    const auto SEQS = std::move(m_deferredRoundtrips);
+    m_deferredRoundtrips.clear();
+
+    for (const auto& seq : SEQS) {
+        sendMessage(CRoundtripRequestMessage(seq));
+    }
+}
+
+void CClientSocket::onRoundtripDone(uint32_t seq) {
+    m_lastAckdRoundtripSeq = seq;
+
+    // the server acks in order, so everything up to seq is done.
+    // Take them out first, as callbacks might request more roundtrips.
+    size_t done = 0;
+    while (done < m_roundtripCallbacks.size() && m_roundtripCallbacks.at(done).first <= seq) {
+        ++done;
+    }
+
+    if (!done)
+        return;
+
+    std::vector<std::pair<uint32_t, std::function<void()>>> callbacks{std::make_move_iterator(m_roundtripCallbacks.begin()),
+                                                                      std::make_move_iterator(m_roundtripCallbacks.begin() + done)};
+    m_roundtripCallbacks.erase(m_roundtripCallbacks.begin(), m_roundtripCallbacks.begin() + done);
+
+    for (const auto& [_, cb] : callbacks) {
+        if (cb)
+            cb();
+    }
 }
@@ -4,15 +4,27 @@
 #include <hyprutils/os/FileDescriptor.hpp>
 #include "../../helpers/Memory.hpp"
 #include "../socket/SocketHelpers.hpp"
+#include "../stream/StreamTable.hpp"
+#include "../strings/StringTable.hpp"
+#include "../fds/FdCache.hpp"
 #include "../wireObject/IWireObject.hpp"
+#include "../message/messages/GenericProtocolMessage.hpp"
+#include "../message/messages/HandshakeAck.hpp"
 
+#include <deque>
 #include <vector>
+#include <unordered_map>
 #include <sys/poll.h>
 
 namespace Hyprwire {
     class IMessage;
     class CClientObject;
-    class CGenericProtocolMessage;
+
+    struct SDeferredMessage {
+        size_t                                      idx = 0; // global order of deferral, used to keep the original send order
+        CGenericProtocolMessage                     msg;
+        std::vector<Hyprutils::OS::CFileDescriptor> fds; // dups of msg's, the caller may close its own once the call returns
+    };
 
     class CClientSocket : public IClientSocket {
       public:
@@ -21,6 +33,9 @@ namespace Hyprwire {
 
         bool                                           attempt(const std::string& path);
         bool                                           attemptFromFd(const int fd);
+        void                                           startOptimistic(uint32_t version);
+        bool                                           reconnectFallback();
+        void                                           uncork();
 
         virtual void                                   addImplementation(SP<IProtocolClientImplementation>&&);
         virtual bool                                   dispatchEvents(bool block);
@@ -31,15 +46,34 @@ namespace Hyprwire {
         virtual SP<IObject>                            objectForId(uint32_t id);
         virtual SP<IObject>                            objectForSeq(uint32_t seq);
         virtual void                                   roundtrip();
+        virtual void                                   roundtripAsync(std::function<void()>&& callback);
         virtual bool                                   isHandshakeDone();
 
         void                                           sendMessage(const IMessage& message);
+        void                                           sendRaw(const std::vector<uint8_t>& bytes, const std::vector<int>& fds);
+        void                                           deferMessage(uint32_t seq, CGenericProtocolMessage&& msg);
+        void                                           flushResolved();
+        void                                           flushRoundtrips();
         void                                           serverSpecs(const std::vector<std::string>& s);
+        void                                           serverSpecsFromQuery(const std::vector<uint32_t>& versions);
+        void                                           onHandshakeDone();
+        CHandshakeAckMessage                           makeAck(uint32_t version);
         void                                           recheckPollFds();
         void                                           onSeq(uint32_t seq, uint32_t id);
+        void                                           onBindRefused(uint32_t seq);
         void                                           onGeneric(const CGenericProtocolMessage& msg);
+        void                                           dispatchCall(SP<CClientObject> obj, const CGenericProtocolMessage& msg);
+        void                                           flushBatch();
+        void                                           onRoundtripDone(uint32_t seq);
         SP<CClientObject>                              makeObject(const std::string& protocolName, const std::string& objectName, uint32_t seq);
         void                                           waitForObject(SP<IWireObject>);
+        uint32_t                                       nextObjectSeq();
+        bool                                           seqInUse(uint32_t seq);
+        void                                           setObjectId(SP<CClientObject> object, uint32_t id);
+        bool                                           clientIds();
+        bool                                           framed();
+        void                                           interestChanged(SP<CClientObject> object);
+        void                                           flushInterest();
 
         void                                           disconnectOnError();
 
@@ -49,9 +83,16 @@ namespace Hyprwire {
         std::vector<pollfd>                            m_pollfds;
         std::vector<SP<CClientObject>>                 m_objects;
 
+        // objects that have an id, by that id
+        std::unordered_map<uint32_t, WP<CClientObject>> m_objectsById;
+
         // this is used when waiting on an object
-        WP<IWireObject>                      m_waitingOnObject;
-        std::vector<CGenericProtocolMessage> m_pendingOutgoing;
+        WP<IWireObject> m_waitingOnObject;
+
+        // messages waiting for a seq to get an id, keyed by that seq. Resolved by onSeq.
+        std::unordered_map<uint32_t, std::deque<SDeferredMessage>> m_pendingOutgoing;
+        std::deque<SDeferredMessage>                               m_resolvedOutgoing;
+        size_t                                                      m_deferredIdx = 0;
         //
 
         bool                                  m_error         = false;
@@ -60,9 +101,45 @@ namespace Hyprwire {
         std::chrono::steady_clock::time_point m_handshakeBegin;
 
         WP<CClientSocket>                     m_self;
-        uint32_t                              m_seq = 0;
+        uint32_t                              m_seq        = 0;
+        bool                                  m_seqWrapped = false;
+
+        uint32_t                              m_version = 0, m_features = 0;
+
+        // optimistic (pipelined) handshake
+        bool                                        m_optimistic = false, m_corked = false, m_ackPending = false;
+        std::vector<uint8_t>                        m_corkedData;
+        std::vector<Hyprutils::OS::CFileDescriptor> m_corkedFds; // dups, like deferred messages
+        std::string                                 m_path;
+        uint32_t                                    m_fallbackVersion = 0;
+        std::vector<WP<CClientObject>>              m_optimisticBinds;
+
+        // protocols we asked for in the handshake, if querying
+        std::vector<std::string>              m_query;
+
+        CStreamTable                          m_streams;
+        CStringTable                          m_strings;
+        CFdCache                              m_fdCache;
+
+        // the start of a FRAME that didn't fully arrive yet, and the fds that came with it
+        SSocketRawParsedMessage               m_partialRead;
+
+        // the run of batched events being collected, see IObject::listenBatch
+        struct {
+            WP<CClientObject> object;
+            uint32_t          method = 0;
+        } m_batch;
+
+        // objects whose listened events changed since we last told the server
+        std::vector<WP<CClientObject>>        m_interestDirty;
+
+        uint32_t                                                m_lastAckdRoundtripSeq = 0;
+        uint32_t                                                m_lastSentRoundtripSeq = 0;
+
+        // outstanding roundtrips, in request (and thus seq) order
+        std::vector<std::pair<uint32_t, std::function<void()>>> m_roundtripCallbacks;
 
-        uint32_t                              m_lastAckdRoundtripSeq = 0;
-        uint32_t                              m_lastSentRoundtripSeq = 0;
+        // roundtrips requested while calls were still deferred, sent once those are
+        std::vector<uint32_t>                                   m_deferredRoundtrips;
     };
 };
\ No newline at end of file
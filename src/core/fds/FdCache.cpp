@@ -0,0 +1,98 @@
+#include "FdCache.hpp"
+#include "../../helpers/Defines.hpp"
+
+#include <sys/stat.h>
+
+using namespace Hyprwire;
+using namespace Hyprutils::OS;
+
+std::optional<CFdCache::SFileKey> CFdCache::keyOf(int fd) {
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0)
+        return std::nullopt;
+
+    return SFileKey{st.st_dev, st.st_ino};
+}
+
+void CFdCache::beginMessage() {
+    m_message++;
+}
+
+std::optional<uint32_t> CFdCache::intern(int fd, bool& define) {
+    define = false;
+
+    const auto KEY = keyOf(fd);
+    if (!KEY)
+        return std::nullopt;
+
+    if (auto it = m_outgoingIds.find(*KEY); it != m_outgoingIds.end()) {
+        m_outgoing.splice(m_outgoing.begin(), m_outgoing, it->second);
+        it->second->lastMessage = m_message;
+        return it->second->id;
+    }
+
+    uint32_t id = 0;
+    if (!m_freeIds.empty()) {
+        id = m_freeIds.back();
+        m_freeIds.pop_back();
+    } else if (m_outgoing.size() < HW_FD_CACHE_SIZE)
+        id = m_outgoing.size();
+    else {
+        // evict the least recently used one, unless this message still needs it. The other side closes it when it's redefined.
+        auto& last = m_outgoing.back();
+        if (last.lastMessage == m_message)
+            return std::nullopt;
+
+        id = last.id;
+        m_outgoingIds.erase(last.key);
+        m_outgoing.pop_back();
+    }
+
+    m_outgoing.emplace_front(SOutgoingFile{.key = *KEY, .id = id, .lastMessage = m_message});
+    m_outgoingIds.emplace(*KEY, m_outgoing.begin());
+
+    define = true;
+    return id;
+}
+
+std::optional<uint32_t> CFdCache::release(int fd) {
+    const auto KEY = keyOf(fd);
+    if (!KEY)
+        return std::nullopt;
+
+    auto it = m_outgoingIds.find(*KEY);
+    if (it == m_outgoingIds.end())
+        return std::nullopt;
+
+    const auto ID = it->second->id;
+    m_outgoing.erase(it->second);
+    m_outgoingIds.erase(it);
+    m_freeIds.emplace_back(ID);
+    return ID;
+}
+
+bool CFdCache::define(uint32_t id, CFileDescriptor&& fd) {
+    if (id >= HW_FD_CACHE_SIZE || !fd.isValid())
+        return false;
+
+    if (m_incoming.size() <= id)
+        m_incoming.resize(id + 1);
+
+    m_incoming.at(id) = std::move(fd);
+    return true;
+}
+
+bool CFdCache::undefine(uint32_t id) {
+    if (id >= m_incoming.size() || !m_incoming.at(id).isValid())
+        return false;
+
+    m_incoming.at(id).reset();
+    return true;
+}
+
+int CFdCache::lookup(uint32_t id) {
+    if (id >= m_incoming.size())
+        return -1;
+
+    return m_incoming.at(id).get();
+}
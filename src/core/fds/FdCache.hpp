@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <sys/types.h>
+
+#include <hyprutils/os/FileDescriptor.hpp>
+
+namespace Hyprwire {
+    // fd ids of one connection, see HW_PROTOCOL_FEATURE_FD_CACHE. Each side picks the ids of the fds it sends, the receiving side
+    // keeps them open. Outgoing fds are told apart by their file (st_dev / st_ino), so we don't have to keep them open ourselves.
+    class CFdCache {
+      public:
+        CFdCache()  = default;
+        ~CFdCache() = default;
+
+        // outgoing. Starts a message: ids it refers to aren't reused until the next one.
+        void                    beginMessage();
+
+        // the id to send fd as. define = the other side doesn't have it yet, send FD_DEFINE with it first.
+        // nullopt if fd can't be stat'ed, or every id is taken by this message.
+        std::optional<uint32_t> intern(int fd, bool& define);
+
+        // forgets the file of fd, returns the id to send FD_RELEASE for. nullopt if it wasn't sent as one.
+        std::optional<uint32_t> release(int fd);
+
+        // incoming. define takes fd, redefining an id closes the old one.
+        bool                    define(uint32_t id, Hyprutils::OS::CFileDescriptor&& fd);
+        bool                    undefine(uint32_t id);
+
+        // -1 if not defined. Open until the id is redefined or released, which the sender won't do while a message refers to it.
+        int                     lookup(uint32_t id);
+
+      private:
+        using SFileKey = std::pair<dev_t, ino_t>;
+
+        struct SOutgoingFile {
+            SFileKey key;
+            uint32_t id          = 0;
+            uint64_t lastMessage = 0;
+        };
+
+        static std::optional<SFileKey>                         keyOf(int fd);
+
+        // most recently used first
+        std::list<SOutgoingFile>                               m_outgoing;
+        std::map<SFileKey, std::list<SOutgoingFile>::iterator> m_outgoingIds;
+        std::vector<uint32_t>                                  m_freeIds; // released ones
+        uint64_t                                               m_message = 0;
+
+        std::vector<Hyprutils::OS::CFileDescriptor>            m_incoming;
+    };
+};
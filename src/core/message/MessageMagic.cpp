@@ -8,11 +8,58 @@ const char* Hyprwire::magicToString(eMessageMagic magic) {
         case HW_MESSAGE_MAGIC_TYPE_F32: return "F32";
         case HW_MESSAGE_MAGIC_TYPE_SEQ: return "SEQUENCE";
         case HW_MESSAGE_MAGIC_TYPE_OBJECT_ID: return "OBJECT_ID";
+        case HW_MESSAGE_MAGIC_TYPE_U64: return "U64";
+        case HW_MESSAGE_MAGIC_TYPE_I64: return "I64";
+        case HW_MESSAGE_MAGIC_TYPE_F64: return "F64";
         case HW_MESSAGE_MAGIC_TYPE_VARCHAR: return "VARCHAR";
+        case HW_MESSAGE_MAGIC_TYPE_VARCHAR_REF: return "VARCHAR_REF";
         case HW_MESSAGE_MAGIC_TYPE_ARRAY: return "ARRAY";
+        case HW_MESSAGE_MAGIC_TYPE_ALIGNED_ARRAY: return "ALIGNED_ARRAY";
+        case HW_MESSAGE_MAGIC_TYPE_STRUCT: return "STRUCT";
+        case HW_MESSAGE_MAGIC_TYPE_PACKED: return "PACKED";
+        case HW_MESSAGE_MAGIC_TYPE_STREAM: return "STREAM";
         case HW_MESSAGE_MAGIC_TYPE_OBJECT: return "OBJECT";
         case HW_MESSAGE_MAGIC_TYPE_FD: return "FD";
+        case HW_MESSAGE_MAGIC_TYPE_CACHED_FD: return "CACHED_FD";
     }
 
     return "ERROR";
 }
+
+size_t Hyprwire::primitiveSize(eMessageMagic magic) {
+    switch (magic) {
+        case HW_MESSAGE_MAGIC_TYPE_UINT:
+        case HW_MESSAGE_MAGIC_TYPE_INT:
+        case HW_MESSAGE_MAGIC_TYPE_F32:
+        case HW_MESSAGE_MAGIC_TYPE_SEQ:
+        case HW_MESSAGE_MAGIC_TYPE_OBJECT_ID:
+        case HW_MESSAGE_MAGIC_TYPE_OBJECT:
+        case HW_MESSAGE_MAGIC_TYPE_STREAM: return 4;
+        case HW_MESSAGE_MAGIC_TYPE_U64:
+        case HW_MESSAGE_MAGIC_TYPE_I64:
+        case HW_MESSAGE_MAGIC_TYPE_F64: return 8;
+        default: return 0;
+    }
+}
+
+bool Hyprwire::isAlignableArrayType(eMessageMagic magic) {
+    switch (magic) {
+        case HW_MESSAGE_MAGIC_TYPE_UINT:
+        case HW_MESSAGE_MAGIC_TYPE_INT:
+        case HW_MESSAGE_MAGIC_TYPE_F32:
+        case HW_MESSAGE_MAGIC_TYPE_U64:
+        case HW_MESSAGE_MAGIC_TYPE_I64:
+        case HW_MESSAGE_MAGIC_TYPE_F64: return true;
+        default: return false;
+    }
+}
+
+bool Hyprwire::isPackableArrayType(eMessageMagic magic) {
+    switch (magic) {
+        case HW_MESSAGE_MAGIC_TYPE_UINT:
+        case HW_MESSAGE_MAGIC_TYPE_INT:
+        case HW_MESSAGE_MAGIC_TYPE_U64:
+        case HW_MESSAGE_MAGIC_TYPE_I64: return true;
+        default: return false;
+    }
+}
\ No newline at end of file
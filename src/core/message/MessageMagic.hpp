@@ -4,4 +4,13 @@
 
 namespace Hyprwire {
     const char* magicToString(eMessageMagic magic);
+
+    // wire size of a fixed-size primitive, 0 for everything else
+    size_t primitiveSize(eMessageMagic magic);
+
+    // element types an ALIGNED_ARRAY may carry
+    bool isAlignableArrayType(eMessageMagic magic);
+
+    // element types a PACKED array may carry
+    bool isPackableArrayType(eMessageMagic magic);
 };
\ No newline at end of file
@@ -18,23 +18,66 @@
 #include "messages/FatalProtocolError.hpp"
 #include "messages/RoundtripDone.hpp"
 #include "messages/RoundtripRequest.hpp"
+#include "messages/EventInterest.hpp"
+#include "messages/StreamData.hpp"
+#include "messages/StringDefine.hpp"
+#include "messages/FdDefine.hpp"
+#include "messages/FdRelease.hpp"
 
 #include <hyprwire/core/implementation/ServerImpl.hpp>
 #include <hyprwire/core/implementation/Spec.hpp>
 #include <algorithm>
+#include <unistd.h>
 
 using namespace Hyprwire;
 
+// puts the partial frame kept from the last read in front of this one. This read is appended to it, so a large frame
+// coming in over many reads isn't copied again each time
+static void restorePartial(SSocketRawParsedMessage& data, SSocketRawParsedMessage& partial) {
+    if (partial.data.empty())
+        return;
+
+    partial.data.append_range(data.data);
+    partial.fds.insert(partial.fds.end(), data.fds.begin(), data.fds.end());
+    data.data = std::move(partial.data);
+    data.fds  = std::move(partial.fds);
+    partial   = {};
+}
+
+// keeps everything from off, and the fds not taken yet, for the next read
+static void keepPartial(SSocketRawParsedMessage& data, size_t off, SSocketRawParsedMessage& partial) {
+    if (off == 0)
+        partial.data = std::move(data.data);
+    else
+        partial.data.assign(data.data.begin() + off, data.data.end());
+
+    partial.fds = std::move(data.fds);
+    data.data.clear();
+    data.fds.clear();
+}
+
 eMessageParsingResult CMessageParser::handleMessage(SSocketRawParsedMessage& data, SP<CServerClient> client) {
+    restorePartial(data, client->m_partialRead);
+
     size_t needle = 0;
     while (needle < data.data.size() && !client->m_error) {
-        auto ret = parseSingleMessage(data, needle, client);
+        bool incomplete = false;
+        auto ret        = data.data.at(needle) == HW_MESSAGE_TYPE_FRAME ? parseFrame(data, needle, client, incomplete) : parseSingleMessage(data, needle, client);
+
+        if (incomplete) {
+            TRACE(Debug::log(TRACE, "[{} @ {:.3f}] <- {} bytes of a frame, waiting for the rest", client->m_fd.get(), steadyMillis(), data.data.size() - needle));
+            keepPartial(data, needle, client->m_partialRead);
+            break;
+        }
+
         if (ret == 0)
             return MESSAGE_PARSED_ERROR;
 
         needle += ret;
     }
 
+    client->flushBatch();
+
     if (!data.fds.empty())
         return MESSAGE_PARSED_STRAY_FDS;
 
@@ -44,15 +87,31 @@ eMessageParsingResult CMessageParser::handleMessage(SSocketRawParsedMessage& dat
 }
 
 eMessageParsingResult CMessageParser::handleMessage(SSocketRawParsedMessage& data, SP<CClientSocket> client) {
+    restorePartial(data, client->m_partialRead);
+
     size_t needle = 0;
     while (needle < data.data.size()) {
-        auto ret = parseSingleMessage(data, needle, client);
+        bool incomplete = false;
+        auto ret        = data.data.at(needle) == HW_MESSAGE_TYPE_FRAME ? parseFrame(data, needle, client, incomplete) : parseSingleMessage(data, needle, client);
+
+        if (incomplete) {
+            TRACE(Debug::log(TRACE, "[{} @ {:.3f}] <- {} bytes of a frame, waiting for the rest", client->m_fd.get(), steadyMillis(), data.data.size() - needle));
+            keepPartial(data, needle, client->m_partialRead);
+            break;
+        }
+
         if (ret == 0)
             return MESSAGE_PARSED_ERROR;
 
         needle += ret;
+
+        // the rest belongs to a connection we are about to drop
+        if (client->m_fallbackVersion)
+            return MESSAGE_PARSED_OK;
     }
 
+    client->flushBatch();
+
     if (!data.fds.empty())
         return MESSAGE_PARSED_STRAY_FDS;
 
@@ -60,10 +119,108 @@ eMessageParsingResult CMessageParser::handleMessage(SSocketRawParsedMessage& dat
     return MESSAGE_PARSED_OK;
 }
 
+template <typename T>
+size_t CMessageParser::parseFrame(SSocketRawParsedMessage& raw, size_t off, SP<T> client, bool& incomplete) {
+    if (!(client->m_features & HW_PROTOCOL_FEATURE_FRAMES)) {
+        Debug::log(ERR, "fd {} core protocol error: frame without the feature", client->m_fd.get());
+        return 0;
+    }
+
+    // the header can be cut off too. A varint is at most 10 bytes, with that many here it's malformed, not cut off.
+    const auto HEADER    = std::span<const uint8_t>{raw.data}.subspan(off + 1);
+    auto [size, sizeLen] = parseVarInt(HEADER);
+
+    if (!sizeLen) {
+        if (HEADER.size() >= 10) {
+            Debug::log(ERR, "fd {} core protocol error: malformed frame size", client->m_fd.get());
+            return 0;
+        }
+
+        incomplete = true;
+        return 0;
+    }
+
+    if (size == 0 || size > HW_MAX_FRAME_SIZE) {
+        Debug::log(ERR, "fd {} core protocol error: frame of {} bytes", client->m_fd.get(), size);
+        return 0;
+    }
+
+    auto [fdCount, fdCountLen] = parseVarInt(HEADER.subspan(sizeLen));
+    const size_t HEADER_LEN    = 1 + sizeLen + fdCountLen;
+
+    if (!fdCountLen) {
+        if (HEADER.size() - sizeLen >= 10) {
+            Debug::log(ERR, "fd {} core protocol error: malformed frame fd count", client->m_fd.get());
+            return 0;
+        }
+
+        incomplete = true;
+        return 0;
+    }
+
+    if (off + HEADER_LEN + size > raw.data.size()) {
+        incomplete = true;
+        return 0;
+    }
+
+    // fds go out with the first bytes of a write, a batch per byte (see sendWithFds). With all of the frame here, they can't be late
+    if (raw.fds.size() < fdCount) {
+        Debug::log(ERR, "fd {} core protocol error: frame with {} fds, but only {} arrived", client->m_fd.get(), fdCount, raw.fds.size());
+        return 0;
+    }
+
+    const auto TYPE = raw.data.at(off + HEADER_LEN);
+
+    if (!messageTypeKnown(TYPE)) {
+        TRACE(Debug::log(TRACE, "[{} @ {:.3f}] <- skipping frame of unknown type {}", client->m_fd.get(), steadyMillis(), TYPE));
+
+        for (size_t i = 0; i < fdCount; ++i) {
+            close(raw.fds.at(i));
+        }
+
+        raw.fds.erase(raw.fds.begin(), raw.fds.begin() + fdCount);
+        return HEADER_LEN + size;
+    }
+
+    if (TYPE == HW_MESSAGE_TYPE_FRAME) {
+        Debug::log(ERR, "fd {} core protocol error: nested frame", client->m_fd.get());
+        return 0;
+    }
+
+    // the fds it made room for belong to the next frame
+    if (TYPE == HW_MESSAGE_TYPE_PADDING) {
+        if (fdCount) {
+            Debug::log(ERR, "fd {} core protocol error: padding frame with {} fds", client->m_fd.get(), fdCount);
+            return 0;
+        }
+
+        return HEADER_LEN + size;
+    }
+
+    const auto FDS_BEFORE = raw.fds.size();
+    const auto RET        = parseSingleMessage(raw, off + HEADER_LEN, client);
+
+    if (RET == 0)
+        return 0;
+
+    if (RET != size || FDS_BEFORE - raw.fds.size() != fdCount) {
+        Debug::log(ERR, "fd {} core protocol error: frame of {} bytes and {} fds had a message of {} bytes and {} fds", client->m_fd.get(), size, fdCount, RET,
+                   FDS_BEFORE - raw.fds.size());
+        return 0;
+    }
+
+    return HEADER_LEN + size;
+}
+
 size_t CMessageParser::parseSingleMessage(SSocketRawParsedMessage& raw, size_t off, SP<CServerClient> client) {
-    auto& data = raw.data;
+    auto&      data = raw.data;
+    const auto TYPE = sc<eMessageType>(data.at(off));
+
+    // a run of batched calls ends at anything else. Checked here, as framed messages get here too.
+    if (TYPE != HW_MESSAGE_TYPE_GENERIC_PROTOCOL_MESSAGE && TYPE != HW_MESSAGE_TYPE_COMPACT_PROTOCOL_MESSAGE && TYPE != HW_MESSAGE_TYPE_STRING_DEFINE)
+        client->flushBatch();
 
-    switch (sc<eMessageType>(data.at(off))) {
+    switch (TYPE) {
         case HW_MESSAGE_TYPE_SUP: {
             auto msg = CHelloMessage(data, off);
             if (!msg.m_len) {
@@ -72,7 +229,11 @@ size_t CMessageParser::parseSingleMessage(SSocketRawParsedMessage& raw, size_t o
             }
             TRACE(Debug::log(TRACE, "[{} @ {:.3f}] <- {}", client->m_fd.get(), steadyMillis(), msg.parseData()));
             client->dispatchFirstPoll();
-            client->sendMessage(CHandshakeBeginMessage(std::vector<uint32_t>{HYPRWIRE_PROTOCOL_VER}));
+            std::vector<uint32_t> versions;
+            for (uint32_t v = HYPRWIRE_PROTOCOL_VER_MIN; v <= HYPRWIRE_PROTOCOL_VER; ++v) {
+                versions.emplace_back(v);
+            }
+            client->sendMessage(CHandshakeBeginMessage(versions));
             return msg.m_len;
         }
         case HW_MESSAGE_TYPE_HANDSHAKE_BEGIN: {
@@ -86,16 +247,48 @@ size_t CMessageParser::parseSingleMessage(SSocketRawParsedMessage& raw, size_t o
                 Debug::log(ERR, "client at fd {} core protocol error: malformed message recvd (HW_MESSAGE_HANDSHAKE_ACK)", client->m_fd.get());
                 return 0;
             }
-            client->m_version = msg.m_version;
 
             TRACE(Debug::log(TRACE, "[{} @ {:.3f}] <- {}", client->m_fd.get(), steadyMillis(), msg.parseData()));
 
+            if (msg.m_version < HYPRWIRE_PROTOCOL_VER_MIN || msg.m_version > HYPRWIRE_PROTOCOL_VER) {
+                client->m_error = true;
+                Debug::log(ERR, "client at fd {} core protocol error: client chose unsupported version {}", client->m_fd.get(), msg.m_version);
+                return 0;
+            }
+
+            client->m_version = msg.m_version;
+
+            // grant whatever features we support out of the requested ones
+            if (client->m_version >= 2)
+                client->m_features = msg.m_features & HYPRWIRE_PROTOCOL_FEATURES;
+
+            if (client->m_features & HW_PROTOCOL_FEATURE_PROTOCOL_QUERY) {
+                // only answer what was asked, 0 means unsupported
+                std::vector<uint32_t> versions;
+                versions.reserve(msg.m_query.size());
+                for (const auto& name : msg.m_query) {
+                    uint32_t ver = 0;
+                    for (const auto& impl : client->m_server->m_impls) {
+                        if (impl->protocol()->specName() != name)
+                            continue;
+
+                        ver = impl->protocol()->specVer();
+                        break;
+                    }
+                    versions.emplace_back(ver);
+                }
+
+                client->m_queriedProtocols = std::move(msg.m_query);
+                client->sendMessage(CHandshakeProtocolsMessage({}, client->m_features, versions));
+                return msg.m_len;
+            }
+
             std::vector<std::string> protocolNames;
             protocolNames.reserve(client->m_server->m_impls.size());
             for (const auto& impl : client->m_server->m_impls) {
                 protocolNames.emplace_back(std::format("{}@{}", impl->protocol()->specName(), impl->protocol()->specVer()));
             }
-            client->sendMessage(CHandshakeProtocolsMessage(protocolNames));
+            client->sendMessage(CHandshakeProtocolsMessage(protocolNames, client->m_version >= 2 ? std::optional<uint32_t>{client->m_features} : std::nullopt));
 
             return msg.m_len;
         }
@@ -113,6 +306,24 @@ size_t CMessageParser::parseSingleMessage(SSocketRawParsedMessage& raw, size_t o
 
             TRACE(Debug::log(TRACE, "[{} @ {:.3f}] <- {}", client->m_fd.get(), steadyMillis(), msg.parseData()));
 
+            if (msg.m_protocolIdx) {
+                if (!(client->m_features & HW_PROTOCOL_FEATURE_PROTOCOL_QUERY) || *msg.m_protocolIdx >= client->m_queriedProtocols.size()) {
+                    client->m_error = true;
+                    Debug::log(ERR, "client at fd {} core protocol error: bind by invalid protocol index {}", client->m_fd.get(), *msg.m_protocolIdx);
+                    return 0;
+                }
+
+                msg.m_protocol = client->m_queriedProtocols.at(*msg.m_protocolIdx);
+            }
+
+            // v2 clients might bind optimistically before seeing our protocols, refuse with id 0 instead of an error.
+            // Sent even with client ids, so that a client waiting on the object doesn't wait forever.
+            if (client->m_version >= 2 && !client->m_server->protocolSupported(msg.m_protocol, msg.m_version)) {
+                Debug::log(WARN, "client at fd {} tried to bind unsupported protocol {}@{}, refusing", client->m_fd.get(), msg.m_protocol, msg.m_version);
+                client->sendMessage(CNewObjectMessage(msg.m_seq, 0));
+                return msg.m_len;
+            }
+
             client->createObject(msg.m_protocol, "", msg.m_version, msg.m_seq);
 
             return msg.m_len;
@@ -122,7 +333,8 @@ size_t CMessageParser::parseSingleMessage(SSocketRawParsedMessage& raw, size_t o
             Debug::log(ERR, "client at fd {} core protocol error: invalid message recvd (HW_MESSAGE_TYPE_NEW_OBJECT)", client->m_fd.get());
             return 0;
         }
-        case HW_MESSAGE_TYPE_GENERIC_PROTOCOL_MESSAGE: {
+        case HW_MESSAGE_TYPE_GENERIC_PROTOCOL_MESSAGE:
+        case HW_MESSAGE_TYPE_COMPACT_PROTOCOL_MESSAGE: {
             auto msg = CGenericProtocolMessage(data, raw.fds, off);
             if (!msg.m_len) {
                 Debug::log(ERR, "server at fd {} core protocol error: malformed message recvd (HW_MESSAGE_TYPE_GENERIC_PROTOCOL_MESSAGE)", client->m_fd.get());
@@ -131,6 +343,12 @@ size_t CMessageParser::parseSingleMessage(SSocketRawParsedMessage& raw, size_t o
 
             TRACE(Debug::log(TRACE, "[{} @ {:.3f}] <- {}", client->m_fd.get(), steadyMillis(), msg.parseData()));
 
+            if (msg.m_compact && client->m_version < HW_PROTOCOL_VER_COMPACT) {
+                client->m_error = true;
+                Debug::log(ERR, "client at fd {} core protocol error: compact message on version {}", client->m_fd.get(), client->m_version);
+                return 0;
+            }
+
             client->onGeneric(msg);
 
             return msg.m_len;
@@ -149,7 +367,8 @@ size_t CMessageParser::parseSingleMessage(SSocketRawParsedMessage& raw, size_t o
 
             TRACE(Debug::log(TRACE, "[{} @ {:.3f}] <- {}", client->m_fd.get(), steadyMillis(), msg.parseData()));
 
-            client->m_scheduledRoundtripSeq = msg.m_seq;
+            // everything before this in the stream has been handled, ack it right here to keep its position
+            client->sendMessage(CRoundtripDoneMessage{msg.m_seq});
 
             return msg.m_len;
         }
@@ -158,6 +377,92 @@ size_t CMessageParser::parseSingleMessage(SSocketRawParsedMessage& raw, size_t o
             Debug::log(ERR, "client at fd {} core protocol error: invalid message recvd (HW_MESSAGE_TYPE_ROUNDTRIP_DONE)", client->m_fd.get());
             return 0;
         }
+        case HW_MESSAGE_TYPE_EVENT_INTEREST: {
+            auto msg = CEventInterestMessage(data, off);
+            if (!msg.m_len) {
+                Debug::log(ERR, "client at fd {} core protocol error: malformed message recvd (HW_MESSAGE_TYPE_EVENT_INTEREST)", client->m_fd.get());
+                return 0;
+            }
+
+            TRACE(Debug::log(TRACE, "[{} @ {:.3f}] <- {}", client->m_fd.get(), steadyMillis(), msg.parseData()));
+
+            if (!(client->m_features & HW_PROTOCOL_FEATURE_EVENT_INTEREST)) {
+                client->m_error = true;
+                Debug::log(ERR, "client at fd {} core protocol error: event interest without the feature", client->m_fd.get());
+                return 0;
+            }
+
+            client->onEventInterest(msg.m_id, std::move(msg.m_mask));
+
+            return msg.m_len;
+        }
+        case HW_MESSAGE_TYPE_STREAM_DATA: {
+            auto msg = CStreamDataMessage(data, off);
+            if (!msg.m_len) {
+                Debug::log(ERR, "client at fd {} core protocol error: malformed message recvd (HW_MESSAGE_TYPE_STREAM_DATA)", client->m_fd.get());
+                return 0;
+            }
+
+            TRACE(Debug::log(TRACE, "[{} @ {:.3f}] <- {}", client->m_fd.get(), steadyMillis(), msg.parseData()));
+
+            client->m_streams.onData(msg.m_stream, msg.m_chunk);
+
+            return msg.m_len;
+        }
+        case HW_MESSAGE_TYPE_STRING_DEFINE: {
+            auto msg = CStringDefineMessage(data, off);
+            if (!msg.m_len) {
+                Debug::log(ERR, "client at fd {} core protocol error: malformed message recvd (HW_MESSAGE_TYPE_STRING_DEFINE)", client->m_fd.get());
+                return 0;
+            }
+
+            TRACE(Debug::log(TRACE, "[{} @ {:.3f}] <- {}", client->m_fd.get(), steadyMillis(), msg.parseData()));
+
+            if (!(client->m_features & HW_PROTOCOL_FEATURE_STRING_TABLE) || !client->m_strings.define(msg.m_id, msg.m_str)) {
+                client->m_error = true;
+                Debug::log(ERR, "client at fd {} core protocol error: invalid string definition {}", client->m_fd.get(), msg.m_id);
+                return 0;
+            }
+
+            return msg.m_len;
+        }
+        case HW_MESSAGE_TYPE_FD_DEFINE: {
+            auto msg = CFdDefineMessage(data, raw.fds, off);
+            if (!msg.m_len) {
+                Debug::log(ERR, "client at fd {} core protocol error: malformed message recvd (HW_MESSAGE_TYPE_FD_DEFINE)", client->m_fd.get());
+                return 0;
+            }
+
+            TRACE(Debug::log(TRACE, "[{} @ {:.3f}] <- {}", client->m_fd.get(), steadyMillis(), msg.parseData()));
+
+            auto fd = Hyprutils::OS::CFileDescriptor{msg.m_fds.front()};
+            if (!(client->m_features & HW_PROTOCOL_FEATURE_FD_CACHE) || !client->m_fdCache.define(msg.m_id, std::move(fd))) {
+                client->m_error = true;
+                Debug::log(ERR, "client at fd {} core protocol error: invalid fd definition {}", client->m_fd.get(), msg.m_id);
+                return 0;
+            }
+
+            return msg.m_len;
+        }
+        case HW_MESSAGE_TYPE_FD_RELEASE: {
+            auto msg = CFdReleaseMessage(data, off);
+            if (!msg.m_len) {
+                Debug::log(ERR, "client at fd {} core protocol error: malformed message recvd (HW_MESSAGE_TYPE_FD_RELEASE)", client->m_fd.get());
+                return 0;
+            }
+
+            TRACE(Debug::log(TRACE, "[{} @ {:.3f}] <- {}", client->m_fd.get(), steadyMillis(), msg.parseData()));
+
+            if (!(client->m_features & HW_PROTOCOL_FEATURE_FD_CACHE) || !client->m_fdCache.undefine(msg.m_id)) {
+                client->m_error = true;
+                Debug::log(ERR, "client at fd {} core protocol error: release of undefined fd {}", client->m_fd.get(), msg.m_id);
+                return 0;
+            }
+
+            return msg.m_len;
+        }
+        case HW_MESSAGE_TYPE_FRAME: // only at the top level
+        case HW_MESSAGE_TYPE_PADDING: // only in a frame
         case HW_MESSAGE_TYPE_INVALID: break;
     }
 
@@ -168,9 +473,14 @@ size_t CMessageParser::parseSingleMessage(SSocketRawParsedMessage& raw, size_t o
 }
 
 size_t CMessageParser::parseSingleMessage(SSocketRawParsedMessage& raw, size_t off, SP<CClientSocket> client) {
-    auto& data = raw.data;
+    auto&      data = raw.data;
+    const auto TYPE = sc<eMessageType>(data.at(off));
+
+    // a run of batched events ends at anything else, see the server side
+    if (TYPE != HW_MESSAGE_TYPE_GENERIC_PROTOCOL_MESSAGE && TYPE != HW_MESSAGE_TYPE_COMPACT_PROTOCOL_MESSAGE && TYPE != HW_MESSAGE_TYPE_STRING_DEFINE)
+        client->flushBatch();
 
-    switch (sc<eMessageType>(data.at(off))) {
+    switch (TYPE) {
         case HW_MESSAGE_TYPE_SUP: {
             client->m_error = true;
             Debug::log(ERR, "server at fd {} core protocol error: invalid message recvd (HW_MESSAGE_TYPE_SUP)", client->m_fd.get());
@@ -183,15 +493,35 @@ size_t CMessageParser::parseSingleMessage(SSocketRawParsedMessage& raw, size_t o
                 return 0;
             }
 
-            if (!std::ranges::contains(msg.m_versionsSupported, HYPRWIRE_PROTOCOL_VER)) {
+            TRACE(Debug::log(TRACE, "[{} @ {:.3f}] <- {}", client->m_fd.get(), steadyMillis(), msg.parseData()));
+
+            // optimistic: we already acked, check if we guessed right
+            if (client->m_optimistic && std::ranges::contains(msg.m_versionsSupported, client->m_version))
+                return msg.m_len;
+
+            // pick the highest version we both support
+            uint32_t chosen = 0;
+            for (uint32_t v = Env::clientMaxVersion(); v >= HYPRWIRE_PROTOCOL_VER_MIN; --v) {
+                if (std::ranges::contains(msg.m_versionsSupported, v)) {
+                    chosen = v;
+                    break;
+                }
+            }
+
+            if (!chosen) {
                 Debug::log(ERR, "server at fd {} core protocol error: version negotiation failed", client->m_fd.get());
                 return 0;
             }
 
-            TRACE(Debug::log(TRACE, "[{} @ {:.3f}] <- {}", client->m_fd.get(), steadyMillis(), msg.parseData()));
+            if (client->m_optimistic) {
+                // guessed wrong, the server will choke on our ack. Start over with a version it knows.
+                client->m_fallbackVersion = chosen;
+                return msg.m_len;
+            }
 
             // version supported: let's select it
-            client->sendMessage(CHandshakeAckMessage(HYPRWIRE_PROTOCOL_VER));
+            client->m_version = chosen;
+            client->sendMessage(client->makeAck(chosen));
 
             return msg.m_len;
         }
@@ -209,7 +539,13 @@ size_t CMessageParser::parseSingleMessage(SSocketRawParsedMessage& raw, size_t o
 
             TRACE(Debug::log(TRACE, "[{} @ {:.3f}] <- {}", client->m_fd.get(), steadyMillis(), msg.parseData()));
 
-            client->serverSpecs(msg.m_protocols);
+            if (client->m_version >= 2)
+                client->m_features = msg.m_features & HYPRWIRE_PROTOCOL_FEATURES;
+
+            if (client->m_features & HW_PROTOCOL_FEATURE_PROTOCOL_QUERY)
+                client->serverSpecsFromQuery(msg.m_queryVersions);
+            else
+                client->serverSpecs(msg.m_protocols);
 
             return msg.m_len;
         }
@@ -231,7 +567,8 @@ size_t CMessageParser::parseSingleMessage(SSocketRawParsedMessage& raw, size_t o
 
             return msg.m_len;
         }
-        case HW_MESSAGE_TYPE_GENERIC_PROTOCOL_MESSAGE: {
+        case HW_MESSAGE_TYPE_GENERIC_PROTOCOL_MESSAGE:
+        case HW_MESSAGE_TYPE_COMPACT_PROTOCOL_MESSAGE: {
             auto msg = CGenericProtocolMessage(data, raw.fds, off);
 
             if (!msg.m_len) {
@@ -239,6 +576,12 @@ size_t CMessageParser::parseSingleMessage(SSocketRawParsedMessage& raw, size_t o
                 return 0;
             }
 
+            if (msg.m_compact && client->m_version < HW_PROTOCOL_VER_COMPACT) {
+                client->m_error = true;
+                Debug::log(ERR, "server at fd {} core protocol error: compact message on version {}", client->m_fd.get(), client->m_version);
+                return 0;
+            }
+
             client->onGeneric(msg);
 
             TRACE(Debug::log(TRACE, "[{} @ {:.3f}] <- {}", client->m_fd.get(), steadyMillis(), msg.parseData()));
@@ -266,10 +609,82 @@ size_t CMessageParser::parseSingleMessage(SSocketRawParsedMessage& raw, size_t o
 
             TRACE(Debug::log(TRACE, "[{} @ {:.3f}] <- {}", client->m_fd.get(), steadyMillis(), msg.parseData()));
 
-            client->m_lastAckdRoundtripSeq = msg.m_seq;
+            client->onRoundtripDone(msg.m_seq);
 
             return msg.m_len;
         }
+        case HW_MESSAGE_TYPE_EVENT_INTEREST: {
+            client->m_error = true;
+            Debug::log(ERR, "server at fd {} core protocol error: invalid message recvd (HW_MESSAGE_TYPE_EVENT_INTEREST)", client->m_fd.get());
+            return 0;
+        }
+        case HW_MESSAGE_TYPE_STREAM_DATA: {
+            auto msg = CStreamDataMessage(data, off);
+            if (!msg.m_len) {
+                Debug::log(ERR, "server at fd {} core protocol error: malformed message recvd (HW_MESSAGE_TYPE_STREAM_DATA)", client->m_fd.get());
+                return 0;
+            }
+
+            TRACE(Debug::log(TRACE, "[{} @ {:.3f}] <- {}", client->m_fd.get(), steadyMillis(), msg.parseData()));
+
+            client->m_streams.onData(msg.m_stream, msg.m_chunk);
+
+            return msg.m_len;
+        }
+        case HW_MESSAGE_TYPE_STRING_DEFINE: {
+            auto msg = CStringDefineMessage(data, off);
+            if (!msg.m_len) {
+                Debug::log(ERR, "server at fd {} core protocol error: malformed message recvd (HW_MESSAGE_TYPE_STRING_DEFINE)", client->m_fd.get());
+                return 0;
+            }
+
+            TRACE(Debug::log(TRACE, "[{} @ {:.3f}] <- {}", client->m_fd.get(), steadyMillis(), msg.parseData()));
+
+            if (!(client->m_features & HW_PROTOCOL_FEATURE_STRING_TABLE) || !client->m_strings.define(msg.m_id, msg.m_str)) {
+                client->m_error = true;
+                Debug::log(ERR, "server at fd {} core protocol error: invalid string definition {}", client->m_fd.get(), msg.m_id);
+                return 0;
+            }
+
+            return msg.m_len;
+        }
+        case HW_MESSAGE_TYPE_FD_DEFINE: {
+            auto msg = CFdDefineMessage(data, raw.fds, off);
+            if (!msg.m_len) {
+                Debug::log(ERR, "server at fd {} core protocol error: malformed message recvd (HW_MESSAGE_TYPE_FD_DEFINE)", client->m_fd.get());
+                return 0;
+            }
+
+            TRACE(Debug::log(TRACE, "[{} @ {:.3f}] <- {}", client->m_fd.get(), steadyMillis(), msg.parseData()));
+
+            auto fd = Hyprutils::OS::CFileDescriptor{msg.m_fds.front()};
+            if (!(client->m_features & HW_PROTOCOL_FEATURE_FD_CACHE) || !client->m_fdCache.define(msg.m_id, std::move(fd))) {
+                client->m_error = true;
+                Debug::log(ERR, "server at fd {} core protocol error: invalid fd definition {}", client->m_fd.get(), msg.m_id);
+                return 0;
+            }
+
+            return msg.m_len;
+        }
+        case HW_MESSAGE_TYPE_FD_RELEASE: {
+            auto msg = CFdReleaseMessage(data, off);
+            if (!msg.m_len) {
+                Debug::log(ERR, "server at fd {} core protocol error: malformed message recvd (HW_MESSAGE_TYPE_FD_RELEASE)", client->m_fd.get());
+                return 0;
+            }
+
+            TRACE(Debug::log(TRACE, "[{} @ {:.3f}] <- {}", client->m_fd.get(), steadyMillis(), msg.parseData()));
+
+            if (!(client->m_features & HW_PROTOCOL_FEATURE_FD_CACHE) || !client->m_fdCache.undefine(msg.m_id)) {
+                client->m_error = true;
+                Debug::log(ERR, "server at fd {} core protocol error: release of undefined fd {}", client->m_fd.get(), msg.m_id);
+                return 0;
+            }
+
+            return msg.m_len;
+        }
+        case HW_MESSAGE_TYPE_FRAME: // only at the top level
+        case HW_MESSAGE_TYPE_PADDING: // only in a frame
         case HW_MESSAGE_TYPE_INVALID: break;
     }
 
@@ -286,26 +701,36 @@ std::pair<size_t, size_t> CMessageParser::parseVarInt(const std::span<const uint
     size_t     rolling = 0;
     size_t     i       = 0;
     const auto LEN     = data.size();
+    if (LEN == 0)
+        return {0, 0};
+
     do {
-        rolling += ((sc<uint8_t>(data[i] << 1) >> 1) << (i * 7));
+        // 10 bytes hold 64 bits, a longer one (or a 10th byte with more than the top bit) is malformed
+        if (i == 10 || (i == 9 && data[i] > 1))
+            return {0, 0};
+
+        rolling += (sc<size_t>(data[i] & 0x7F) << (i * 7));
         i++;
     } while (i < LEN && (data[i - 1] & 0x80));
 
+    // cut off by the end of the data
+    if (data[i - 1] & 0x80)
+        return {0, 0};
+
     return {rolling, i};
 }
 
 std::vector<uint8_t> CMessageParser::encodeVarInt(size_t num) {
     std::vector<uint8_t> data;
-    data.resize(4);
-    data[0] = (uint8_t)((num << 25) >> 25) | 0x80;
-    data[1] = (uint8_t)((num << 18) >> 25) | 0x80;
-    data[2] = (uint8_t)((num << 11) >> 25) | 0x80;
-    data[3] = (uint8_t)((num << 4) >> 25) | 0x80;
-    while (data.back() == 0x80 && data.size() > 1) {
-        data.pop_back();
-    }
+    appendVarInt(data, num);
+    return data;
+}
 
-    data.back() &= ~0x80;
+void CMessageParser::appendVarInt(std::vector<uint8_t>& data, size_t num) {
+    while (num >= 0x80) {
+        data.emplace_back(sc<uint8_t>(num) | 0x80);
+        num >>= 7;
+    }
 
-    return data;
+    data.emplace_back(sc<uint8_t>(num));
 }
@@ -28,10 +28,15 @@ namespace Hyprwire {
         std::pair<size_t, size_t> parseVarInt(const std::vector<uint8_t>& data, size_t offset);
         std::pair<size_t, size_t> parseVarInt(const std::span<const uint8_t>& data);
         std::vector<uint8_t>      encodeVarInt(size_t num);
+        void                      appendVarInt(std::vector<uint8_t>& data, size_t num);
 
       private:
         size_t parseSingleMessage(SSocketRawParsedMessage& data, size_t off, SP<CServerClient> client);
         size_t parseSingleMessage(SSocketRawParsedMessage& data, size_t off, SP<CClientSocket> client);
+
+        // a FRAME at off. Returns its length, or 0 on error or if it isn't all here yet (incomplete is set then).
+        template <typename T>
+        size_t parseFrame(SSocketRawParsedMessage& data, size_t off, SP<T> client, bool& incomplete);
     };
 
     inline UP<CMessageParser> g_messageParser = makeUnique<CMessageParser>();
@@ -20,24 +20,25 @@ namespace Hyprwire {
 
         /*
             Sent by the client to confirm a choice of a protocol version
-            Params: uint -> version chosen
+            Params: uint -> version chosen, (v2+) uint -> requested features mask, (PROTOCOL_QUERY) arr(str) -> protocol names wanted
         */
         HW_MESSAGE_TYPE_HANDSHAKE_ACK = 3,
 
         /*
             Sent by the server to advertise supported protocols
-            Params: arr(str) -> protocols
+            Params: arr(str) -> protocols, (v2+) uint -> granted features mask, (PROTOCOL_QUERY) arr(uint) -> versions of the queried protocols
         */
         HW_MESSAGE_TYPE_HANDSHAKE_PROTOCOLS = 4,
 
         /*
             Sent by the client to bind to a specific protocol spec
-            Params: uint -> seq, str -> protocol spec
+            Params: uint -> seq, str -> protocol spec (or (PROTOCOL_QUERY) uint -> index in the query), uint -> version
         */
         HW_MESSAGE_TYPE_BIND_PROTOCOL = 10,
 
         /*
-            Sent by the server to acknowledge the bind and return a handle
+            Sent by the server to acknowledge the bind and return a handle.
+            Not sent if HW_PROTOCOL_FEATURE_CLIENT_IDS is active.
             Params: uint -> object handle ID, uint -> seq
         */
         HW_MESSAGE_TYPE_NEW_OBJECT = 11,
@@ -60,11 +61,66 @@ namespace Hyprwire {
         */
         HW_MESSAGE_TYPE_ROUNDTRIP_DONE = 14,
 
+        /*
+            Sent from the client to declare which events of an object it listens to. Needs HW_PROTOCOL_FEATURE_EVENT_INTEREST.
+            Params: uint -> object handle ID, arr(uint) -> bitmask of s2c method ids, 32 per element
+        */
+        HW_MESSAGE_TYPE_EVENT_INTEREST = 15,
+
+        /*
+            A chunk of a STREAM argument. Can be either direction, interleaved with any other messages.
+            Chunks of a stream follow the message carrying its id, in order.
+            Params: uint -> stream id, varchar -> data, at most HW_STREAM_CHUNK_SIZE bytes. Empty data ends the stream.
+        */
+        HW_MESSAGE_TYPE_STREAM_DATA = 16,
+
+        /*
+            Wraps one message, needs HW_PROTOCOL_FEATURE_FRAMES. Can be either direction.
+            Frames with a message of an unknown type are skipped, their fds closed.
+            Params: varint -> message length, varint -> fd count, the message
+        */
+        HW_MESSAGE_TYPE_FRAME = 17,
+
+        /*
+            Sets a string table id of the sender, needs HW_PROTOCOL_FEATURE_STRING_TABLE. Can be either direction.
+            Sent before the message that refers to it, a redefined id replaces the old string.
+            Params: uint -> id, below HW_STRING_TABLE_SIZE, varchar -> the string, at most HW_STRING_TABLE_MAX_LEN bytes
+        */
+        HW_MESSAGE_TYPE_STRING_DEFINE = 18,
+
+        /*
+            Sets an fd cache id of the sender, needs HW_PROTOCOL_FEATURE_FD_CACHE. Can be either direction.
+            Sent before the message that refers to it. The receiver keeps the fd open until the id is redefined or released.
+            Params: uint -> id, below HW_FD_CACHE_SIZE, fd -> the fd
+        */
+        HW_MESSAGE_TYPE_FD_DEFINE = 19,
+
+        /*
+            Closes the fd of an fd cache id of the sender, needs HW_PROTOCOL_FEATURE_FD_CACHE. Can be either direction.
+            Params: uint -> id
+        */
+        HW_MESSAGE_TYPE_FD_RELEASE = 20,
+
+        /*
+            Filler in front of a frame whose fds need more bytes to go with than it has, see sendWithFds. Only sent in a FRAME with no fds,
+            the receiver skips it.
+            Params: any bytes
+        */
+        HW_MESSAGE_TYPE_PADDING = 21,
+
         /*
             Generic protocol message. Can be either direction.
             Params: uint -> object handle ID, uint -> method ID, data...
         */
         HW_MESSAGE_TYPE_GENERIC_PROTOCOL_MESSAGE = 100,
+
+        /*
+            Generic protocol message in the compact format (v3+). Can be either direction.
+            Args have no magics, they are encoded as the method's params say.
+            Params: varint -> object handle ID (compacted), varint -> method ID, varint -> data length << 1 | has fds,
+            (has fds) varint -> fd count, data...
+        */
+        HW_MESSAGE_TYPE_COMPACT_PROTOCOL_MESSAGE = 101,
     };
 
     inline const char* messageTypeToStr(eMessageType t) {
@@ -78,9 +134,41 @@ namespace Hyprwire {
             case HW_MESSAGE_TYPE_NEW_OBJECT: return "NEW_OBJECT";
             case HW_MESSAGE_TYPE_FATAL_PROTOCOL_ERROR: return "HW_MESSAGE_TYPE_FATAL_PROTOCOL_ERROR";
             case HW_MESSAGE_TYPE_GENERIC_PROTOCOL_MESSAGE: return "GENERIC_PROTOCOL_MESSAGE";
+            case HW_MESSAGE_TYPE_COMPACT_PROTOCOL_MESSAGE: return "COMPACT_PROTOCOL_MESSAGE";
             case HW_MESSAGE_TYPE_ROUNDTRIP_REQUEST: return "HW_MESSAGE_TYPE_ROUNDTRIP_REQUEST";
             case HW_MESSAGE_TYPE_ROUNDTRIP_DONE: return "HW_MESSAGE_TYPE_ROUNDTRIP_DONE";
+            case HW_MESSAGE_TYPE_EVENT_INTEREST: return "EVENT_INTEREST";
+            case HW_MESSAGE_TYPE_STREAM_DATA: return "STREAM_DATA";
+            case HW_MESSAGE_TYPE_FRAME: return "FRAME";
+            case HW_MESSAGE_TYPE_STRING_DEFINE: return "STRING_DEFINE";
+            case HW_MESSAGE_TYPE_FD_DEFINE: return "FD_DEFINE";
+            case HW_MESSAGE_TYPE_FD_RELEASE: return "FD_RELEASE";
+            case HW_MESSAGE_TYPE_PADDING: return "PADDING";
         }
         return "ERROR";
     }
+
+    inline bool messageTypeKnown(uint8_t t) {
+        switch (t) {
+            case HW_MESSAGE_TYPE_SUP:
+            case HW_MESSAGE_TYPE_HANDSHAKE_BEGIN:
+            case HW_MESSAGE_TYPE_HANDSHAKE_ACK:
+            case HW_MESSAGE_TYPE_HANDSHAKE_PROTOCOLS:
+            case HW_MESSAGE_TYPE_BIND_PROTOCOL:
+            case HW_MESSAGE_TYPE_NEW_OBJECT:
+            case HW_MESSAGE_TYPE_FATAL_PROTOCOL_ERROR:
+            case HW_MESSAGE_TYPE_ROUNDTRIP_REQUEST:
+            case HW_MESSAGE_TYPE_ROUNDTRIP_DONE:
+            case HW_MESSAGE_TYPE_EVENT_INTEREST:
+            case HW_MESSAGE_TYPE_STREAM_DATA:
+            case HW_MESSAGE_TYPE_FRAME:
+            case HW_MESSAGE_TYPE_STRING_DEFINE:
+            case HW_MESSAGE_TYPE_FD_DEFINE:
+            case HW_MESSAGE_TYPE_FD_RELEASE:
+            case HW_MESSAGE_TYPE_PADDING:
+            case HW_MESSAGE_TYPE_GENERIC_PROTOCOL_MESSAGE:
+            case HW_MESSAGE_TYPE_COMPACT_PROTOCOL_MESSAGE: return true;
+            default: return false;
+        }
+    }
 };
\ No newline at end of file
@@ -0,0 +1,209 @@
+#include "PackedArray.hpp"
+#include "MessageMagic.hpp"
+#include "MessageParser.hpp"
+#include "messages/GenericProtocolMessage.hpp"
+#include "../../helpers/Defines.hpp"
+#include "../../helpers/Memory.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+using namespace Hyprwire;
+
+// the varint of a value: signed ones are zigzagged, in 64 bits so that it's the same for both widths
+template <typename T>
+static uint64_t toWire(T v) {
+    if constexpr (std::is_signed_v<T>)
+        return zigZag(v);
+    else
+        return v;
+}
+
+template <typename T>
+static bool fromWire(uint64_t v, T& out) {
+    if constexpr (std::is_signed_v<T>) {
+        const int64_t VAL = unZigZag(v);
+        if (VAL < std::numeric_limits<T>::min() || VAL > std::numeric_limits<T>::max())
+            return false;
+        out = VAL;
+    } else {
+        if (v > std::numeric_limits<T>::max())
+            return false;
+        out = v;
+    }
+    return true;
+}
+
+// differences wrap around in the element's width, so any sequence has one
+template <typename T>
+static uint64_t deltaToWire(T prev, T cur) {
+    using U = std::make_unsigned_t<T>;
+    using S = std::make_signed_t<T>;
+    return zigZag(sc<S>(sc<U>(sc<U>(cur) - sc<U>(prev))));
+}
+
+template <typename T>
+static bool deltaFromWire(uint64_t v, T prev, T& out) {
+    using U = std::make_unsigned_t<T>;
+    using S = std::make_signed_t<T>;
+    S delta = 0;
+    if (!fromWire<S>(v, delta))
+        return false;
+    out = sc<T>(sc<U>(sc<U>(prev) + sc<U>(delta)));
+    return true;
+}
+
+static bool readVarInt(std::span<const uint8_t> in, size_t& needle, uint64_t& out) {
+    uint64_t val = 0;
+    for (size_t i = 0; i < 10 && needle < in.size(); ++i) {
+        const uint8_t BYTE = in[needle++];
+        val |= sc<uint64_t>(BYTE & 0x7F) << (i * 7);
+        if (!(BYTE & 0x80)) {
+            out = val;
+            return true;
+        }
+    }
+    return false;
+}
+
+// runs of elements below 0x80 are one byte each, those are taken 8 at a time. Returns how many elements were written.
+template <typename T>
+static size_t unpackSmall(std::span<const uint8_t> in, size_t& needle, T* out, size_t count) {
+    size_t i = 0;
+    while (i + 8 <= count && needle + 8 <= in.size()) {
+        uint64_t word = 0;
+        std::memcpy(&word, &in[needle], sizeof(word));
+        if (word & 0x8080808080808080ULL)
+            break;
+
+        for (size_t j = 0; j < 8; ++j) {
+            fromWire<T>(in[needle + j], out[i + j]);
+        }
+
+        i += 8;
+        needle += 8;
+    }
+    return i;
+}
+
+template <typename T>
+static void pack(std::vector<uint8_t>& out, eArrayEncoding encoding, const T* data, size_t count) {
+    switch (encoding) {
+        case HW_ARRAY_ENCODING_VARINT: {
+            for (size_t i = 0; i < count; ++i) {
+                g_messageParser->appendVarInt(out, toWire(data[i]));
+            }
+            break;
+        }
+        case HW_ARRAY_ENCODING_DELTA_VARINT: {
+            T prev = 0;
+            for (size_t i = 0; i < count; ++i) {
+                g_messageParser->appendVarInt(out, deltaToWire(prev, data[i]));
+                prev = data[i];
+            }
+            break;
+        }
+        case HW_ARRAY_ENCODING_RLE: {
+            for (size_t i = 0; i < count;) {
+                size_t run = 1;
+                while (i + run < count && data[i + run] == data[i]) {
+                    run++;
+                }
+
+                g_messageParser->appendVarInt(out, toWire(data[i]));
+                g_messageParser->appendVarInt(out, run);
+                i += run;
+            }
+            break;
+        }
+        default: break;
+    }
+}
+
+template <typename T>
+static bool unpack(std::span<const uint8_t> in, eArrayEncoding encoding, T* out, size_t count) {
+    size_t   needle = 0;
+    uint64_t v      = 0;
+
+    switch (encoding) {
+        case HW_ARRAY_ENCODING_VARINT: {
+            for (size_t i = 0; i < count;) {
+                i += unpackSmall(in, needle, out + i, count - i);
+                if (i == count)
+                    break;
+
+                if (!readVarInt(in, needle, v) || !fromWire<T>(v, out[i]))
+                    return false;
+                i++;
+            }
+            break;
+        }
+        case HW_ARRAY_ENCODING_DELTA_VARINT: {
+            // sorted ids mostly have small deltas: decode them in bulk, then sum them up
+            T prev = 0;
+            for (size_t i = 0; i < count;) {
+                const size_t SMALL = unpackSmall<std::make_signed_t<T>>(in, needle, rc<std::make_signed_t<T>*>(out + i), count - i);
+                for (size_t j = i; j < i + SMALL; ++j) {
+                    out[j] = prev = sc<T>(sc<std::make_unsigned_t<T>>(prev) + sc<std::make_unsigned_t<T>>(out[j]));
+                }
+                i += SMALL;
+                if (i == count)
+                    break;
+
+                if (!readVarInt(in, needle, v) || !deltaFromWire<T>(v, prev, out[i]))
+                    return false;
+                prev = out[i++];
+            }
+            break;
+        }
+        case HW_ARRAY_ENCODING_RLE: {
+            for (size_t i = 0; i < count;) {
+                T        val = 0;
+                uint64_t run = 0;
+                if (!readVarInt(in, needle, v) || !fromWire<T>(v, val) || !readVarInt(in, needle, run) || run == 0 || run > count - i)
+                    return false;
+
+                std::fill_n(out + i, run, val);
+                i += run;
+            }
+            break;
+        }
+        default: return false;
+    }
+
+    return needle == in.size();
+}
+
+void Hyprwire::packArray(std::vector<uint8_t>& out, eMessageMagic type, eArrayEncoding encoding, const void* data, size_t count) {
+    switch (type) {
+        case HW_MESSAGE_MAGIC_TYPE_UINT: pack(out, encoding, sc<const uint32_t*>(data), count); break;
+        case HW_MESSAGE_MAGIC_TYPE_INT: pack(out, encoding, sc<const int32_t*>(data), count); break;
+        case HW_MESSAGE_MAGIC_TYPE_U64: pack(out, encoding, sc<const uint64_t*>(data), count); break;
+        case HW_MESSAGE_MAGIC_TYPE_I64: pack(out, encoding, sc<const int64_t*>(data), count); break;
+        default: break;
+    }
+}
+
+bool Hyprwire::unpackArray(std::span<const uint8_t> in, eMessageMagic type, eArrayEncoding encoding, void* out, size_t count) {
+    switch (type) {
+        case HW_MESSAGE_MAGIC_TYPE_UINT: return unpack(in, encoding, sc<uint32_t*>(out), count);
+        case HW_MESSAGE_MAGIC_TYPE_INT: return unpack(in, encoding, sc<int32_t*>(out), count);
+        case HW_MESSAGE_MAGIC_TYPE_U64: return unpack(in, encoding, sc<uint64_t*>(out), count);
+        case HW_MESSAGE_MAGIC_TYPE_I64: return unpack(in, encoding, sc<int64_t*>(out), count);
+        default: return false;
+    }
+}
+
+bool Hyprwire::packedArrayFits(eMessageMagic type, eArrayEncoding encoding, size_t count, size_t size) {
+    if (!isPackableArrayType(type))
+        return false;
+
+    switch (encoding) {
+        case HW_ARRAY_ENCODING_VARINT:
+        case HW_ARRAY_ENCODING_DELTA_VARINT: return count <= size;
+        case HW_ARRAY_ENCODING_RLE: return count <= HW_MAX_FRAME_SIZE / primitiveSize(type);
+        default: return false;
+    }
+}
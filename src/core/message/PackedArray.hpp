@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <hyprwire/core/types/MessageMagic.hpp>
+
+namespace Hyprwire {
+    // appends count elements of type (see isPackableArrayType) at data, encoded as encoding says
+    void packArray(std::vector<uint8_t>& out, eMessageMagic type, eArrayEncoding encoding, const void* data, size_t count);
+
+    // decodes exactly count elements into out, which has room for them. False if in isn't exactly that, or a value doesn't fit the type.
+    bool unpackArray(std::span<const uint8_t> in, eMessageMagic type, eArrayEncoding encoding, void* out, size_t count);
+
+    // whether a PACKED array of count elements may be received. RLE can describe more elements than it has bytes,
+    // so the decoded array is capped at HW_MAX_FRAME_SIZE.
+    bool packedArrayFits(eMessageMagic type, eArrayEncoding encoding, size_t count, size_t size);
+}
@@ -22,18 +22,27 @@ CBindProtocolMessage::CBindProtocolMessage(const std::vector<uint8_t>& data, siz
 
         std::memcpy(&m_seq, &data.at(offset + 2), sizeof(m_seq));
 
-        if (data.at(offset + 6) != HW_MESSAGE_MAGIC_TYPE_VARCHAR)
-            return;
-
         size_t needle = 7;
 
-        auto [strLen, varIntLen] = g_messageParser->parseVarInt(data, offset + needle);
+        if (data.at(offset + 6) == HW_MESSAGE_MAGIC_TYPE_UINT) {
+            // by index into the protocol query
+            uint32_t idx = 0;
+            std::memcpy(&idx, &data.at(offset + needle), sizeof(idx));
+            m_protocolIdx = idx;
+            needle += 4;
+        } else if (data.at(offset + 6) == HW_MESSAGE_MAGIC_TYPE_VARCHAR) {
+            auto [strLen, varIntLen] = g_messageParser->parseVarInt(data, offset + needle);
+
+            if (!varIntLen)
+                return;
 
-        needle += varIntLen;
+            needle += varIntLen;
 
-        m_protocol = std::string_view{rc<const char*>(&data.at(offset + needle)), strLen};
+            m_protocol = std::string_view{rc<const char*>(&data.at(offset + needle)), strLen};
 
-        needle += strLen;
+            needle += strLen;
+        } else
+            return;
 
         if (data.at(offset + needle) != HW_MESSAGE_MAGIC_TYPE_UINT)
             return;
@@ -76,3 +85,15 @@ CBindProtocolMessage::CBindProtocolMessage(const std::string& protocol, uint32_t
 
     m_data.emplace_back(HW_MESSAGE_MAGIC_END);
 }
+
+CBindProtocolMessage::CBindProtocolMessage(uint32_t protocolIdx, uint32_t seq, uint32_t version) : m_seq(seq), m_version(version), m_protocolIdx(protocolIdx) {
+    m_type = HW_MESSAGE_TYPE_BIND_PROTOCOL;
+
+    m_data = {
+        HW_MESSAGE_TYPE_BIND_PROTOCOL, HW_MESSAGE_MAGIC_TYPE_UINT, 0, 0, 0, 0, HW_MESSAGE_MAGIC_TYPE_UINT, 0, 0, 0, 0, HW_MESSAGE_MAGIC_TYPE_UINT, 0, 0, 0, 0, HW_MESSAGE_MAGIC_END,
+    };
+
+    std::memcpy(&m_data[2], &seq, sizeof(seq));
+    std::memcpy(&m_data[7], &protocolIdx, sizeof(protocolIdx));
+    std::memcpy(&m_data[12], &version, sizeof(version));
+}
@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <cstdint>
+#include <optional>
 
 #include "IMessage.hpp"
 
@@ -10,10 +11,14 @@ namespace Hyprwire {
       public:
         CBindProtocolMessage(const std::vector<uint8_t>& data, size_t offset);
         CBindProtocolMessage(const std::string& protocol, uint32_t seq, uint32_t version);
+        CBindProtocolMessage(uint32_t protocolIdx, uint32_t seq, uint32_t version);
 
         virtual ~CBindProtocolMessage() = default;
 
-        std::string m_protocol;
-        uint32_t    m_seq = 0, m_version = 0;
+        std::string             m_protocol;
+        uint32_t                m_seq = 0, m_version = 0;
+
+        // set if bound by index into the protocol query
+        std::optional<uint32_t> m_protocolIdx;
     };
 };
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include "EventInterest.hpp"
+#include "../MessageType.hpp"
+#include "../MessageParser.hpp"
+#include "../../../helpers/Env.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <hyprwire/core/types/MessageMagic.hpp>
+
+using namespace Hyprwire;
+
+CEventInterestMessage::CEventInterestMessage(const std::vector<uint8_t>& data, size_t offset) {
+    m_type = HW_MESSAGE_TYPE_EVENT_INTEREST;
+
+    try {
+        if (data.at(offset + 0) != HW_MESSAGE_TYPE_EVENT_INTEREST)
+            return;
+
+        if (data.at(offset + 1) != HW_MESSAGE_MAGIC_TYPE_UINT)
+            return;
+
+        if ((data.size() - offset - 2) < sizeof(m_id))
+            return;
+
+        std::memcpy(&m_id, &data.at(offset + 2), sizeof(m_id));
+
+        if (data.at(offset + 6) != HW_MESSAGE_MAGIC_TYPE_ARRAY)
+            return;
+
+        if (data.at(offset + 7) != HW_MESSAGE_MAGIC_TYPE_UINT)
+            return;
+
+        size_t needle = 8;
+
+        auto [els, varIntLen] = g_messageParser->parseVarInt(data, offset + needle);
+
+        if (!varIntLen)
+            return;
+
+        needle += varIntLen;
+
+        // don't allocate for a bogus length
+        if (els > (data.size() - offset - needle) / sizeof(uint32_t))
+            return;
+
+        if (data.at(offset + needle + (els * sizeof(uint32_t))) != HW_MESSAGE_MAGIC_END)
+            return;
+
+        m_mask.resize(els);
+
+        if (els)
+            std::memcpy(m_mask.data(), &data.at(offset + needle), els * sizeof(uint32_t));
+
+        needle += els * sizeof(uint32_t);
+
+        m_len = needle + 1;
+
+        if (Env::isTrace())
+            m_data = std::vector<uint8_t>{data.begin() + offset, data.begin() + offset + m_len - 1};
+
+    } catch (std::out_of_range& e) { m_len = 0; }
+}
+
+CEventInterestMessage::CEventInterestMessage(uint32_t id, const std::vector<uint32_t>& mask) : m_id(id), m_mask(mask) {
+    m_type = HW_MESSAGE_TYPE_EVENT_INTEREST;
+
+    m_data = {HW_MESSAGE_TYPE_EVENT_INTEREST, HW_MESSAGE_MAGIC_TYPE_UINT, 0, 0, 0, 0, HW_MESSAGE_MAGIC_TYPE_ARRAY, HW_MESSAGE_MAGIC_TYPE_UINT};
+
+    std::memcpy(&m_data[2], &id, sizeof(id));
+
+    m_data.append_range(g_messageParser->encodeVarInt(mask.size()));
+
+    const size_t HEAD_SIZE = m_data.size();
+
+    m_data.resize(HEAD_SIZE + (mask.size() * sizeof(uint32_t)));
+
+    if (!mask.empty())
+        std::memcpy(&m_data[HEAD_SIZE], mask.data(), mask.size() * sizeof(uint32_t));
+
+    m_data.emplace_back(HW_MESSAGE_MAGIC_END);
+}
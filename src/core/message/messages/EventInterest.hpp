@@ -0,0 +1,19 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "IMessage.hpp"
+
+namespace Hyprwire {
+    class CEventInterestMessage : public IMessage {
+      public:
+        CEventInterestMessage(const std::vector<uint8_t>& data, size_t offset);
+        CEventInterestMessage(uint32_t id, const std::vector<uint32_t>& mask);
+
+        virtual ~CEventInterestMessage() = default;
+
+        uint32_t              m_id = 0;
+        std::vector<uint32_t> m_mask;
+    };
+};
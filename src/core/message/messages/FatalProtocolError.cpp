@@ -35,6 +35,9 @@ CFatalErrorMessage::CFatalErrorMessage(const std::vector<uint8_t>& data, size_t
 
         auto [strLen, strLenLen] = g_messageParser->parseVarInt(data, offset + needle);
 
+        if (!strLenLen)
+            return;
+
         needle += strLenLen;
 
         m_errorMsg = std::string{rc<const char*>(data.data() + offset + needle), strLen};
@@ -0,0 +1,53 @@
+#include "FdDefine.hpp"
+#include "../MessageType.hpp"
+#include "../../../helpers/Env.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <hyprwire/core/types/MessageMagic.hpp>
+
+using namespace Hyprwire;
+
+CFdDefineMessage::CFdDefineMessage(const std::vector<uint8_t>& data, std::deque<int>& fds, size_t offset) {
+    m_type = HW_MESSAGE_TYPE_FD_DEFINE;
+
+    try {
+        if (data.at(offset + 0) != HW_MESSAGE_TYPE_FD_DEFINE)
+            return;
+
+        if (data.at(offset + 1) != HW_MESSAGE_MAGIC_TYPE_UINT)
+            return;
+
+        if ((data.size() - offset - 2) < sizeof(m_id))
+            return;
+
+        std::memcpy(&m_id, &data.at(offset + 2), sizeof(m_id));
+
+        if (data.at(offset + 6) != HW_MESSAGE_MAGIC_TYPE_FD || data.at(offset + 7) != HW_MESSAGE_MAGIC_END)
+            return;
+
+        if (fds.empty())
+            return;
+
+        m_fds.emplace_back(fds.front());
+        fds.pop_front();
+
+        m_len = 8;
+
+        if (Env::isTrace())
+            m_data = std::vector<uint8_t>{data.begin() + offset, data.begin() + offset + m_len - 1};
+
+    } catch (std::out_of_range& e) { m_len = 0; }
+}
+
+CFdDefineMessage::CFdDefineMessage(uint32_t id, int fd) : m_id(id), m_fds({fd}) {
+    m_type = HW_MESSAGE_TYPE_FD_DEFINE;
+
+    m_data = {HW_MESSAGE_TYPE_FD_DEFINE, HW_MESSAGE_MAGIC_TYPE_UINT, 0, 0, 0, 0, HW_MESSAGE_MAGIC_TYPE_FD, HW_MESSAGE_MAGIC_END};
+
+    std::memcpy(&m_data[2], &id, sizeof(id));
+}
+
+const std::vector<int>& CFdDefineMessage::fds() const {
+    return m_fds;
+}
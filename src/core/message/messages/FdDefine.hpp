@@ -0,0 +1,22 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <cstdint>
+
+#include "IMessage.hpp"
+
+namespace Hyprwire {
+    class CFdDefineMessage : public IMessage {
+      public:
+        CFdDefineMessage(const std::vector<uint8_t>& data, std::deque<int>& fds, size_t offset);
+        CFdDefineMessage(uint32_t id, int fd);
+
+        virtual ~CFdDefineMessage() = default;
+
+        virtual const std::vector<int>& fds() const;
+
+        uint32_t                        m_id = 0;
+        std::vector<int>                m_fds;
+    };
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "IMessage.hpp"
+
+namespace Hyprwire {
+    class CFdReleaseMessage : public IMessage {
+      public:
+        CFdReleaseMessage(const std::vector<uint8_t>& data, size_t offset);
+        CFdReleaseMessage(uint32_t id);
+
+        virtual ~CFdReleaseMessage() = default;
+
+        uint32_t m_id = 0;
+    };
+};
@@ -1,8 +1,11 @@
 #include "GenericProtocolMessage.hpp"
 #include "../MessageType.hpp"
 #include "../MessageParser.hpp"
+#include "../MessageMagic.hpp"
+#include "../PackedArray.hpp"
 #include "../../../helpers/Env.hpp"
 #include "../../../helpers/Log.hpp"
+#include "../../../helpers/Defines.hpp"
 
 #include <cstring>
 #include <stdexcept>
@@ -10,10 +13,55 @@
 
 using namespace Hyprwire;
 
-CGenericProtocolMessage::CGenericProtocolMessage(const std::vector<uint8_t>& data, std::vector<int>& fds, size_t offset) {
+// [type][OBJECT][object : 4B][UINT][method : 4B], the args follow
+constexpr const size_t GENERIC_HEADER_LEN = 11;
+
+// a varint at needle that ends within data
+static bool readVarInt(const std::span<const uint8_t>& data, size_t& needle, uint64_t& out) {
+    if (needle >= data.size())
+        return false;
+
+    auto [val, len] = g_messageParser->parseVarInt(data.subspan(needle));
+    if (!len)
+        return false;
+
+    needle += len;
+    out = val;
+    return true;
+}
+
+CGenericProtocolMessage::CGenericProtocolMessage(const std::vector<uint8_t>& data, std::deque<int>& fds, size_t offset) {
     m_type = HW_MESSAGE_TYPE_GENERIC_PROTOCOL_MESSAGE;
 
     try {
+        if (data.at(offset + 0) == HW_MESSAGE_TYPE_COMPACT_PROTOCOL_MESSAGE) {
+            m_type    = HW_MESSAGE_TYPE_COMPACT_PROTOCOL_MESSAGE;
+            m_compact = true;
+
+            // the args are framed once the method is known, see frameCompact
+            SCompactHeader header;
+            if (!parseCompactHeader(std::span<const uint8_t>{data}.subspan(offset), header) || offset + header.len + header.size > data.size())
+                return;
+
+            if (fds.size() < header.fds) {
+                Debug::log(TRACE, "GenericProtocolMessage: compact message with {} fds but fd queue has {}", header.fds, fds.size());
+                return;
+            }
+
+            m_object = header.object;
+            m_method = header.method;
+            m_fds.assign(fds.begin(), fds.begin() + header.fds);
+            fds.erase(fds.begin(), fds.begin() + header.fds);
+
+            m_len      = header.len + header.size;
+            m_dataSpan = std::span<const uint8_t>{data.begin() + offset + header.len, header.size};
+
+            if (Env::isTrace())
+                m_data = std::vector<uint8_t>{data.begin() + offset, data.begin() + offset + m_len};
+
+            return;
+        }
+
         if (data.at(offset + 0) != HW_MESSAGE_TYPE_GENERIC_PROTOCOL_MESSAGE)
             return;
 
@@ -27,38 +75,140 @@ CGenericProtocolMessage::CGenericProtocolMessage(const std::vector<uint8_t>& dat
 
         std::memcpy(&m_method, &data.at(offset + 7), sizeof(m_method));
 
-        size_t i = 11;
+        // the only pass over the args: record where each one is, so that decoding doesn't parse them again
+        size_t i = GENERIC_HEADER_LEN;
         while (data.at(offset + i) != HW_MESSAGE_MAGIC_END) {
-            switch (sc<eMessageMagic>(data.at(offset + i))) {
+            const auto MAGIC = sc<eMessageMagic>(data.at(offset + i));
+            auto&      arg   = m_args.emplace_back(SWireArgument{.type = MAGIC, .offset = sc<uint32_t>(i - GENERIC_HEADER_LEN + 1)});
+
+            switch (MAGIC) {
                 case HW_MESSAGE_MAGIC_TYPE_UINT:
                 case HW_MESSAGE_MAGIC_TYPE_F32:
                 case HW_MESSAGE_MAGIC_TYPE_INT:
                 case HW_MESSAGE_MAGIC_TYPE_OBJECT:
+                case HW_MESSAGE_MAGIC_TYPE_OBJECT_ID:
+                case HW_MESSAGE_MAGIC_TYPE_STREAM:
                 case HW_MESSAGE_MAGIC_TYPE_SEQ: i += 5; break;
+                case HW_MESSAGE_MAGIC_TYPE_U64:
+                case HW_MESSAGE_MAGIC_TYPE_I64:
+                case HW_MESSAGE_MAGIC_TYPE_F64: i += 9; break;
                 case HW_MESSAGE_MAGIC_TYPE_VARCHAR: {
+                    if (offset + i + 1 >= data.size())
+                        return;
+
                     auto [a, b] = g_messageParser->parseVarInt(data, offset + i + 1);
+
+                    // the length comes off the wire: it has to fit in what's left, and in the arg
+                    if (!b || a > data.size() - (offset + i + 1 + b) || a > UINT32_MAX) {
+                        Debug::log(TRACE, "GenericProtocolMessage: varchar of {} bytes past the end", a);
+                        return;
+                    }
+
+                    arg.offset += b;
+                    arg.count   = sc<uint32_t>(a);
                     i += a + b + 1;
                     break;
                 }
+                case HW_MESSAGE_MAGIC_TYPE_VARCHAR_REF: {
+                    if (offset + i + 1 >= data.size())
+                        return;
+
+                    // to the method it's a regular varchar, resolved when it's called
+                    auto [id, idLen] = g_messageParser->parseVarInt(data, offset + i + 1);
+                    if (!idLen)
+                        return;
+
+                    arg.type     = HW_MESSAGE_MAGIC_TYPE_VARCHAR;
+                    arg.interned = true;
+                    arg.value    = id;
+                    i += idLen + 1;
+                    break;
+                }
                 case HW_MESSAGE_MAGIC_TYPE_ARRAY: {
-                    const auto arrType    = sc<eMessageMagic>(data.at(offset + i + 1));
-                    auto [arrLen, lenLen] = g_messageParser->parseVarInt(std::span<const uint8_t>{&data[offset + i + 2], data.size() - i});
+                    const auto arrType = sc<eMessageMagic>(data.at(offset + i + 1));
+
+                    if (offset + i + 2 >= data.size())
+                        return;
+
+                    auto [arrLen, lenLen] = g_messageParser->parseVarInt(data, offset + i + 2);
                     size_t arrMessageLen  = 2 + lenLen;
 
+                    if (!lenLen || arrLen > UINT32_MAX)
+                        return;
+
+                    arg.arrType = arrType;
+                    arg.offset += 1 + lenLen;
+                    arg.count   = sc<uint32_t>(arrLen);
+
                     switch (arrType) {
                         case HW_MESSAGE_MAGIC_TYPE_UINT:
                         case HW_MESSAGE_MAGIC_TYPE_F32:
                         case HW_MESSAGE_MAGIC_TYPE_INT:
                         case HW_MESSAGE_MAGIC_TYPE_OBJECT:
-                        case HW_MESSAGE_MAGIC_TYPE_SEQ: {
-                            arrMessageLen += 4 * arrLen;
+                        case HW_MESSAGE_MAGIC_TYPE_SEQ:
+                        case HW_MESSAGE_MAGIC_TYPE_U64:
+                        case HW_MESSAGE_MAGIC_TYPE_I64:
+                        case HW_MESSAGE_MAGIC_TYPE_F64: {
+                            if (offset + i + arrMessageLen > data.size() || arrLen > (data.size() - (offset + i + arrMessageLen)) / primitiveSize(arrType))
+                                return;
+
+                            arrMessageLen += primitiveSize(arrType) * arrLen;
+                            break;
+                        }
+                        case HW_MESSAGE_MAGIC_TYPE_STRUCT: {
+                            if (offset + i + arrMessageLen >= data.size())
+                                return;
+
+                            auto [elSize, elSizeLen] = g_messageParser->parseVarInt(data, offset + i + arrMessageLen);
+                            arrMessageLen += elSizeLen;
+
+                            // structs have fields, and the elements have to fit in what's left. Checked before multiplying, it could overflow
+                            if (!elSizeLen || elSize == 0 || elSize > UINT32_MAX || arrLen > (data.size() - (offset + i + arrMessageLen)) / elSize) {
+                                Debug::log(TRACE, "GenericProtocolMessage: {} structs of {} bytes past the end", arrLen, elSize);
+                                return;
+                            }
+
+                            arg.offset += elSizeLen;
+                            arg.elemSize = sc<uint32_t>(elSize);
+
+                            arrMessageLen += elSize * arrLen;
+                            break;
+                        }
+                        case HW_MESSAGE_MAGIC_TYPE_PACKED: {
+                            if (offset + i + arrMessageLen + 2 >= data.size())
+                                return;
+
+                            arg.packedType = sc<eMessageMagic>(data.at(offset + i + arrMessageLen));
+                            arg.encoding   = sc<eArrayEncoding>(data.at(offset + i + arrMessageLen + 1));
+                            arrMessageLen += 2;
+
+                            auto [size, sizeLen] = g_messageParser->parseVarInt(data, offset + i + arrMessageLen);
+                            arrMessageLen += sizeLen;
+
+                            if (!sizeLen || !packedArrayFits(arg.packedType, arg.encoding, arrLen, size)) {
+                                Debug::log(TRACE, "GenericProtocolMessage: packed array of {} elements in {} bytes", arrLen, size);
+                                return;
+                            }
+
+                            arg.offset += 2 + sizeLen;
+                            arg.size = size;
+
+                            arrMessageLen += size;
                             break;
                         }
                         case HW_MESSAGE_MAGIC_TYPE_VARCHAR: {
                             for (size_t j = 0; j < arrLen; ++j) {
-                                auto [strLen, strlenLen] =
-                                    g_messageParser->parseVarInt(std::span<const uint8_t>{&data[offset + i + arrMessageLen], data.size() - i - arrMessageLen});
+                                if (offset + i + arrMessageLen >= data.size())
+                                    return;
+
+                                auto [strLen, strlenLen] = g_messageParser->parseVarInt(data, offset + i + arrMessageLen);
+                                if (!strlenLen || strLen > data.size() - (offset + i + arrMessageLen + strlenLen))
+                                    return;
+
                                 arrMessageLen += strLen + strlenLen;
+
+                                if (offset + i + arrMessageLen >= data.size())
+                                    return;
                             }
                             break;
                         }
@@ -67,8 +217,8 @@ CGenericProtocolMessage::CGenericProtocolMessage(const std::vector<uint8_t>& dat
                                 if (fds.empty())
                                     return;
 
-                                m_fds.emplace_back(fds[0]);
-                                fds.erase(fds.begin(), fds.begin() + 1);
+                                m_fds.emplace_back(fds.front());
+                                fds.pop_front();
                             }
 
                             i += 0;
@@ -83,18 +233,67 @@ CGenericProtocolMessage::CGenericProtocolMessage(const std::vector<uint8_t>& dat
                     i += arrMessageLen;
                     break;
                 }
+                case HW_MESSAGE_MAGIC_TYPE_ALIGNED_ARRAY: {
+                    const auto arrType = sc<eMessageMagic>(data.at(offset + i + 1));
+
+                    if (!isAlignableArrayType(arrType)) {
+                        Debug::log(TRACE, "GenericProtocolMessage: aligned array of {}", magicToString(arrType));
+                        return;
+                    }
+
+                    if (offset + i + 2 >= data.size())
+                        return;
+
+                    auto [arrLen, lenLen] = g_messageParser->parseVarInt(data, offset + i + 2);
+                    if (!lenLen)
+                        return;
+
+                    const size_t PAD   = data.at(offset + i + 2 + lenLen);
+                    const size_t START = i + 2 + lenLen + 1 + PAD;
+
+                    if (PAD >= HW_ARRAY_ALIGNMENT || START % HW_ARRAY_ALIGNMENT != 0) {
+                        Debug::log(TRACE, "GenericProtocolMessage: misaligned aligned array");
+                        return;
+                    }
+
+                    if (offset + START > data.size() || arrLen > (data.size() - (offset + START)) / primitiveSize(arrType))
+                        return;
+
+                    // to the method it's a regular array
+                    arg.type    = HW_MESSAGE_MAGIC_TYPE_ARRAY;
+                    arg.arrType = arrType;
+                    arg.offset  = START - GENERIC_HEADER_LEN;
+                    arg.count   = sc<uint32_t>(arrLen);
+                    arg.aligned = true;
+
+                    i = START + primitiveSize(arrType) * arrLen;
+                    break;
+                }
                 case HW_MESSAGE_MAGIC_TYPE_FD: {
                     if (fds.empty()) {
                         Debug::log(TRACE, "GenericProtocolMessage: HW_MESSAGE_MAGIC_TYPE_FD but fd queue is empty");
                         return;
                     }
 
-                    m_fds.emplace_back(fds[0]);
-                    fds.erase(fds.begin(), fds.begin() + 1);
+                    m_fds.emplace_back(fds.front());
+                    fds.pop_front();
 
                     i += 1;
                     break;
                 }
+                case HW_MESSAGE_MAGIC_TYPE_CACHED_FD: {
+                    if (offset + i + 1 >= data.size())
+                        return;
+
+                    auto [id, idLen] = g_messageParser->parseVarInt(data, offset + i + 1);
+                    if (!idLen || id >= HW_FD_CACHE_SIZE)
+                        return;
+
+                    arg.interned = true;
+                    arg.value    = id;
+                    i += idLen + 1;
+                    break;
+                }
                 default: {
                     Debug::log(TRACE, "GenericProtocolMessage: failed demarshaling array message");
                     return;
@@ -104,7 +303,7 @@ CGenericProtocolMessage::CGenericProtocolMessage(const std::vector<uint8_t>& dat
 
         m_len = i + 1;
 
-        m_dataSpan = std::span<const uint8_t>{data.begin() + 11 + offset, m_len - 11};
+        m_dataSpan = std::span<const uint8_t>{data.begin() + GENERIC_HEADER_LEN + offset, m_len - GENERIC_HEADER_LEN};
 
         if (Env::isTrace())
             m_data = std::vector<uint8_t>{data.begin() + offset, data.begin() + offset + m_len - 1};
@@ -117,12 +316,224 @@ CGenericProtocolMessage::CGenericProtocolMessage(std::vector<uint8_t>&& data, st
     m_type = HW_MESSAGE_TYPE_GENERIC_PROTOCOL_MESSAGE;
 }
 
+CGenericProtocolMessage::CGenericProtocolMessage(uint32_t object, uint32_t method, const std::vector<uint8_t>& payload, std::vector<int>&& fds) : m_fds(std::move(fds)) {
+    m_type    = HW_MESSAGE_TYPE_COMPACT_PROTOCOL_MESSAGE;
+    m_compact = true;
+    m_object  = object;
+    m_method  = method;
+
+    m_data.reserve(payload.size() + 8);
+    m_data.emplace_back(HW_MESSAGE_TYPE_COMPACT_PROTOCOL_MESSAGE);
+    g_messageParser->appendVarInt(m_data, compactObjectId(object));
+    g_messageParser->appendVarInt(m_data, method);
+    g_messageParser->appendVarInt(m_data, (payload.size() << 1) | (m_fds.empty() ? 0 : 1));
+    if (!m_fds.empty())
+        g_messageParser->appendVarInt(m_data, m_fds.size());
+    m_data.append_range(payload);
+}
+
 const std::vector<int>& CGenericProtocolMessage::fds() const {
     return m_fds;
 }
 
 void CGenericProtocolMessage::resolveSeq(uint32_t id) {
     m_object = id;
-    if (m_data.size() > 2)
-        m_data[2] = id;
+
+    if (!m_compact) {
+        if (m_data.size() > 6)
+            std::memcpy(&m_data[2], &id, sizeof(id));
+        return;
+    }
+
+    // the id is a varint, it might not take as much space as the placeholder
+    size_t   needle = 1;
+    uint64_t old    = 0;
+    if (!readVarInt(m_data, needle, old))
+        return;
+
+    std::vector<uint8_t> newId;
+    g_messageParser->appendVarInt(newId, compactObjectId(id));
+    m_data.erase(m_data.begin() + 1, m_data.begin() + needle);
+    m_data.insert(m_data.begin() + 1, newId.begin(), newId.end());
+}
+
+bool CGenericProtocolMessage::parseCompactHeader(const std::span<const uint8_t>& data, SCompactHeader& header) {
+    size_t   needle = 1;
+    uint64_t object = 0, method = 0, size = 0, fds = 0;
+
+    if (!readVarInt(data, needle, object) || !readVarInt(data, needle, method) || !readVarInt(data, needle, size))
+        return false;
+
+    if ((size & 1) && !readVarInt(data, needle, fds))
+        return false;
+
+    if (object > UINT32_MAX || method > UINT32_MAX)
+        return false;
+
+    header.object = expandObjectId(object);
+    header.method = method;
+    header.size   = size >> 1;
+    header.fds    = fds;
+    header.len    = needle;
+    return true;
+}
+
+bool CGenericProtocolMessage::frameCompact(const std::vector<uint8_t>& params, const std::span<const uint8_t>& data, size_t fds, bool alignedArrays,
+                                           std::vector<SWireArgument>& args) {
+    size_t needle = 0, fdsUsed = 0;
+
+    args.reserve(params.size());
+
+    for (size_t i = 0; i < params.size(); ++i) {
+        const auto PARAM = sc<eMessageMagic>(params.at(i));
+        auto&      arg   = args.emplace_back(SWireArgument{.type = PARAM, .offset = sc<uint32_t>(needle)});
+
+        switch (PARAM) {
+            case HW_MESSAGE_MAGIC_TYPE_UINT:
+            case HW_MESSAGE_MAGIC_TYPE_OBJECT:
+            case HW_MESSAGE_MAGIC_TYPE_OBJECT_ID:
+            case HW_MESSAGE_MAGIC_TYPE_STREAM:
+            case HW_MESSAGE_MAGIC_TYPE_SEQ: {
+                if (!readVarInt(data, needle, arg.value) || arg.value > UINT32_MAX)
+                    return false;
+                break;
+            }
+            case HW_MESSAGE_MAGIC_TYPE_INT:
+            case HW_MESSAGE_MAGIC_TYPE_I64: {
+                if (!readVarInt(data, needle, arg.value) || (PARAM == HW_MESSAGE_MAGIC_TYPE_INT && arg.value > UINT32_MAX))
+                    return false;
+                arg.value = unZigZag(arg.value);
+                break;
+            }
+            case HW_MESSAGE_MAGIC_TYPE_U64: {
+                if (!readVarInt(data, needle, arg.value))
+                    return false;
+                break;
+            }
+            case HW_MESSAGE_MAGIC_TYPE_F32:
+            case HW_MESSAGE_MAGIC_TYPE_F64: {
+                needle += primitiveSize(PARAM);
+                if (needle > data.size())
+                    return false;
+                break;
+            }
+            case HW_MESSAGE_MAGIC_TYPE_VARCHAR: {
+                uint64_t head = 0;
+                if (!readVarInt(data, needle, head))
+                    return false;
+
+                // id << 1 | 1 for a string table id, len << 1 otherwise
+                if (head & 1) {
+                    arg.interned = true;
+                    arg.value    = head >> 1;
+                    break;
+                }
+
+                const uint64_t LEN = head >> 1;
+                if (LEN > data.size() - needle || LEN > UINT32_MAX)
+                    return false;
+
+                arg.offset = needle;
+                arg.count  = sc<uint32_t>(LEN);
+                needle += LEN;
+                break;
+            }
+            case HW_MESSAGE_MAGIC_TYPE_ARRAY: {
+                const auto arrType = sc<eMessageMagic>(params.at(++i));
+                uint64_t   arrLen  = 0;
+                if (!readVarInt(data, needle, arrLen) || arrLen > UINT32_MAX)
+                    return false;
+
+                arg.arrType = arrType;
+                arg.count   = arrLen;
+
+                switch (arrType) {
+                    case HW_MESSAGE_MAGIC_TYPE_UINT:
+                    case HW_MESSAGE_MAGIC_TYPE_F32:
+                    case HW_MESSAGE_MAGIC_TYPE_INT:
+                    case HW_MESSAGE_MAGIC_TYPE_OBJECT:
+                    case HW_MESSAGE_MAGIC_TYPE_SEQ:
+                    case HW_MESSAGE_MAGIC_TYPE_U64:
+                    case HW_MESSAGE_MAGIC_TYPE_I64:
+                    case HW_MESSAGE_MAGIC_TYPE_F64: {
+                        // no magic to tell a padded array apart, so it's padded whenever the sender would send ALIGNED_ARRAY
+                        if (alignedArrays && arrLen >= HW_ALIGNED_ARRAY_MIN_ELEMENTS && isAlignableArrayType(arrType)) {
+                            if (needle >= data.size())
+                                return false;
+
+                            const size_t PAD = data[needle];
+                            needle += 1 + PAD;
+                            if (PAD >= HW_ARRAY_ALIGNMENT || needle % HW_ARRAY_ALIGNMENT != 0)
+                                return false;
+
+                            arg.aligned = true;
+                        }
+
+                        arg.offset = needle;
+                        needle += primitiveSize(arrType) * arrLen;
+                        break;
+                    }
+                    case HW_MESSAGE_MAGIC_TYPE_STRUCT: {
+                        arg.elemSize = params.at(++i);
+                        arg.offset   = needle;
+                        needle += arg.elemSize * arrLen;
+                        break;
+                    }
+                    case HW_MESSAGE_MAGIC_TYPE_PACKED: {
+                        arg.packedType = sc<eMessageMagic>(params.at(++i));
+                        arg.encoding   = sc<eArrayEncoding>(params.at(++i));
+
+                        uint64_t size = 0;
+                        if (!readVarInt(data, needle, size) || size > data.size() - needle || !packedArrayFits(arg.packedType, arg.encoding, arrLen, size))
+                            return false;
+
+                        arg.offset = needle;
+                        arg.size   = size;
+                        needle += size;
+                        break;
+                    }
+                    case HW_MESSAGE_MAGIC_TYPE_VARCHAR: {
+                        arg.offset = needle;
+                        for (size_t j = 0; j < arrLen; ++j) {
+                            uint64_t len = 0;
+                            if (!readVarInt(data, needle, len) || len > data.size() - needle)
+                                return false;
+                            needle += len;
+                        }
+                        break;
+                    }
+                    case HW_MESSAGE_MAGIC_TYPE_FD: {
+                        fdsUsed += arrLen;
+                        break;
+                    }
+                    default: return false;
+                }
+
+                if (needle > data.size())
+                    return false;
+                break;
+            }
+            case HW_MESSAGE_MAGIC_TYPE_FD: {
+                fdsUsed++;
+                break;
+            }
+            case HW_MESSAGE_MAGIC_TYPE_CACHED_FD: {
+                uint64_t head = 0;
+                if (!readVarInt(data, needle, head) || head > HW_FD_CACHE_SIZE)
+                    return false;
+
+                if (head == 0) {
+                    fdsUsed++;
+                    break;
+                }
+
+                arg.interned = true;
+                arg.value    = head - 1;
+                break;
+            }
+            default: return false;
+        }
+    }
+
+    return needle == data.size() && fdsUsed == fds;
 }
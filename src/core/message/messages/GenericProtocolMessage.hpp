@@ -1,15 +1,59 @@
 #pragma once
 
+#include <deque>
 #include <vector>
 #include <cstdint>
 
 #include "IMessage.hpp"
+#include "../../../helpers/Defines.hpp"
+#include "../../../helpers/Memory.hpp"
+#include <hyprwire/core/types/MessageMagic.hpp>
 
 namespace Hyprwire {
+    // one argument of a received message, recorded while framing it
+    struct SWireArgument {
+        eMessageMagic  type = HW_MESSAGE_MAGIC_END, arrType = HW_MESSAGE_MAGIC_END;
+        uint32_t       offset     = 0;                      // relative to m_dataSpan: the value, the string bytes, or the first array element
+        uint32_t       count      = 0;                      // string length or array length
+        uint32_t       elemSize   = 0;                      // STRUCT arrays
+        uint32_t       size       = 0;                      // PACKED arrays: the encoded size of the elements
+        eMessageMagic  packedType = HW_MESSAGE_MAGIC_END;   // PACKED arrays: the element type
+        eArrayEncoding encoding   = HW_ARRAY_ENCODING_NONE; // PACKED arrays: how the elements are encoded
+        bool           aligned    = false;                  // sent as ALIGNED_ARRAY, or padded in a compact message
+        bool           interned   = false;                  // VARCHAR sent as a string table id, or CACHED_FD as an fd cache id, which is in value
+        uint64_t       value      = 0;                      // compact messages: the decoded integer, signed ones sign-extended
+    };
+
+    // head of a COMPACT_PROTOCOL_MESSAGE
+    struct SCompactHeader {
+        uint32_t object = 0, method = 0;
+        size_t   size = 0; // of the data
+        size_t   fds  = 0;
+        size_t   len  = 0; // of the header itself, type included
+    };
+
+    // client-allocated ids are above HW_CLIENT_ID_BASE, as they are they'd always take 5 bytes
+    inline uint64_t compactObjectId(uint32_t id) {
+        return id >= HW_CLIENT_ID_BASE ? ((sc<uint64_t>(id - HW_CLIENT_ID_BASE) << 1) | 1) : sc<uint64_t>(id) << 1;
+    }
+
+    inline uint32_t expandObjectId(uint64_t v) {
+        return (v & 1) ? sc<uint32_t>(v >> 1) + HW_CLIENT_ID_BASE : sc<uint32_t>(v >> 1);
+    }
+
+    inline uint64_t zigZag(int64_t v) {
+        return (sc<uint64_t>(v) << 1) ^ sc<uint64_t>(v >> 63);
+    }
+
+    inline int64_t unZigZag(uint64_t v) {
+        return sc<int64_t>(v >> 1) ^ -sc<int64_t>(v & 1);
+    }
+
     class CGenericProtocolMessage : public IMessage {
       public:
-        CGenericProtocolMessage(const std::vector<uint8_t>& data, std::vector<int>& fds, size_t offset);
+        CGenericProtocolMessage(const std::vector<uint8_t>& data, std::deque<int>& fds, size_t offset);
         CGenericProtocolMessage(std::vector<uint8_t>&& data, std::vector<int>&& fds);
+        CGenericProtocolMessage(uint32_t object, uint32_t method, const std::vector<uint8_t>& payload, std::vector<int>&& fds);
 
         virtual ~CGenericProtocolMessage() = default;
 
@@ -17,11 +61,19 @@ namespace Hyprwire {
 
         void                            resolveSeq(uint32_t id);
 
+        static bool                     parseCompactHeader(const std::span<const uint8_t>& data, SCompactHeader& header);
+
+        // records where the args of a compact message are by the method's params. False if they don't fit the data.
+        static bool                     frameCompact(const std::vector<uint8_t>& params, const std::span<const uint8_t>& data, size_t fds, bool alignedArrays,
+                                                     std::vector<SWireArgument>& args);
+
         uint32_t                        m_object       = 0;
         uint32_t                        m_dependsOnSeq = 0;
         uint32_t                        m_method       = 0;
+        bool                            m_compact      = false;
 
         std::span<const uint8_t>        m_dataSpan;
+        std::vector<SWireArgument>      m_args;
         std::vector<int>                m_fds;
     };
 };
\ No newline at end of file
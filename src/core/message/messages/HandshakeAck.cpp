@@ -2,9 +2,11 @@
 #include "../MessageType.hpp"
 #include "../MessageParser.hpp"
 #include "../../../helpers/Env.hpp"
+#include "../../../helpers/Defines.hpp"
 
 #include <cstring>
 #include <stdexcept>
+#include <string_view>
 #include <hyprwire/core/types/MessageMagic.hpp>
 
 using namespace Hyprwire;
@@ -21,9 +23,6 @@ CHandshakeAckMessage::CHandshakeAckMessage(const std::vector<uint8_t>& data, siz
 
         size_t needle = 2;
 
-        if (data.at(offset + needle + 4) != HW_MESSAGE_MAGIC_END)
-            return;
-
         if ((data.size() - offset - needle) < sizeof(m_version))
             return;
 
@@ -31,6 +30,49 @@ CHandshakeAckMessage::CHandshakeAckMessage(const std::vector<uint8_t>& data, siz
 
         needle += 4;
 
+        // v2+: features requested by the client
+        if (data.at(offset + needle) == HW_MESSAGE_MAGIC_TYPE_UINT) {
+            if (data.size() - offset - needle - 1 < sizeof(m_features))
+                return;
+
+            std::memcpy(&m_features, &data.at(offset + needle + 1), sizeof(m_features));
+            needle += 5;
+
+            // protocol query
+            if (data.at(offset + needle) == HW_MESSAGE_MAGIC_TYPE_ARRAY) {
+                if (data.at(offset + needle + 1) != HW_MESSAGE_MAGIC_TYPE_VARCHAR)
+                    return;
+
+                needle += 2;
+
+                auto [els, varIntLen] = g_messageParser->parseVarInt(data, offset + needle);
+
+                if (!varIntLen)
+                    return;
+
+                needle += varIntLen;
+
+                // don't allocate for a bogus length, every entry takes at least a byte
+                if (offset + needle > data.size() || els > data.size() - offset - needle)
+                    return;
+
+                m_query.resize(els);
+
+                for (size_t i = 0; i < els; ++i) {
+                    auto [strLen, strLenLen] = g_messageParser->parseVarInt(data, offset + needle);
+
+                    if (!strLenLen || strLen > data.size() - offset - needle - strLenLen)
+                        return;
+
+                    m_query.at(i) = std::string_view{rc<const char*>(&data.at(offset + needle + strLenLen)), strLen};
+                    needle += strLen + strLenLen;
+                }
+            }
+        }
+
+        if (data.at(offset + needle) != HW_MESSAGE_MAGIC_END)
+            return;
+
         m_len = needle + 1;
 
         if (Env::isTrace())
@@ -38,10 +80,10 @@ CHandshakeAckMessage::CHandshakeAckMessage(const std::vector<uint8_t>& data, siz
     } catch (std::out_of_range& e) { m_len = 0; }
 }
 
-CHandshakeAckMessage::CHandshakeAckMessage(uint32_t version) {
+CHandshakeAckMessage::CHandshakeAckMessage(uint32_t version, uint32_t features, const std::vector<std::string>& query) : m_version(version), m_features(features) {
     m_type = HW_MESSAGE_TYPE_HANDSHAKE_ACK;
 
-    m_data.reserve(7);
+    m_data.reserve(12);
 
     m_data = {
         HW_MESSAGE_TYPE_HANDSHAKE_ACK,
@@ -52,5 +94,25 @@ CHandshakeAckMessage::CHandshakeAckMessage(uint32_t version) {
 
     std::memcpy(&m_data[2], &version, sizeof(version));
 
+    // v1 peers don't know about features, don't send them.
+    if (version >= 2) {
+        m_data.emplace_back(HW_MESSAGE_MAGIC_TYPE_UINT);
+        m_data.resize(11);
+        std::memcpy(&m_data[7], &features, sizeof(features));
+
+        if (features & HW_PROTOCOL_FEATURE_PROTOCOL_QUERY) {
+            m_query = query;
+
+            m_data.emplace_back(HW_MESSAGE_MAGIC_TYPE_ARRAY);
+            m_data.emplace_back(HW_MESSAGE_MAGIC_TYPE_VARCHAR);
+            m_data.append_range(g_messageParser->encodeVarInt(query.size()));
+
+            for (const auto& q : query) {
+                m_data.append_range(g_messageParser->encodeVarInt(q.size()));
+                m_data.append_range(q);
+            }
+        }
+    }
+
     m_data.emplace_back(HW_MESSAGE_MAGIC_END);
 }
@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <cstdint>
+#include <string>
 
 #include "IMessage.hpp"
 
@@ -9,10 +10,11 @@ namespace Hyprwire {
     class CHandshakeAckMessage : public IMessage {
       public:
         CHandshakeAckMessage(const std::vector<uint8_t>& data, size_t offset);
-        CHandshakeAckMessage(uint32_t version);
+        CHandshakeAckMessage(uint32_t version, uint32_t features = 0, const std::vector<std::string>& query = {});
 
         virtual ~CHandshakeAckMessage() = default;
 
-        uint32_t m_version = 0;
+        uint32_t                 m_version = 0, m_features = 0;
+        std::vector<std::string> m_query;
     };
 };
\ No newline at end of file
@@ -26,6 +26,9 @@ CHandshakeBeginMessage::CHandshakeBeginMessage(const std::vector<uint8_t>& data,
 
         auto [nVers, varIntLen] = g_messageParser->parseVarInt(data, offset + needle);
 
+        if (!varIntLen)
+            return;
+
         needle += varIntLen;
 
         m_versionsSupported.resize(nVers);
@@ -3,6 +3,7 @@
 #include "../MessageParser.hpp"
 #include "../../../helpers/Env.hpp"
 
+#include <cstring>
 #include <stdexcept>
 #include <string_view>
 #include <hyprwire/core/types/MessageMagic.hpp>
@@ -26,17 +27,62 @@ CHandshakeProtocolsMessage::CHandshakeProtocolsMessage(const std::vector<uint8_t
 
         auto [els, varIntLen] = g_messageParser->parseVarInt(data, offset + needle);
 
+        if (!varIntLen)
+            return;
+
         needle += varIntLen;
 
+        // don't allocate for a bogus length, every entry takes at least a byte
+        if (offset + needle > data.size() || els > data.size() - offset - needle)
+            return;
+
         m_protocols.resize(els);
 
         for (size_t i = 0; i < els; ++i) {
             auto [strLen, strLenLen] = g_messageParser->parseVarInt(data, offset + needle);
 
+            if (!strLenLen || strLen > data.size() - offset - needle - strLenLen)
+                return;
+
             m_protocols.at(i) = std::string_view{rc<const char*>(&data.at(offset + needle + strLenLen)), strLen};
             needle += strLen + strLenLen;
         }
 
+        // v2+: features granted by the server
+        if (data.at(offset + needle) == HW_MESSAGE_MAGIC_TYPE_UINT) {
+            if (data.size() - offset - needle - 1 < sizeof(m_features))
+                return;
+
+            std::memcpy(&m_features, &data.at(offset + needle + 1), sizeof(m_features));
+            needle += 5;
+
+            // answer to a protocol query, versions in query order
+            if (data.at(offset + needle) == HW_MESSAGE_MAGIC_TYPE_ARRAY) {
+                if (data.at(offset + needle + 1) != HW_MESSAGE_MAGIC_TYPE_UINT)
+                    return;
+
+                needle += 2;
+
+                auto [nVers, varIntLen] = g_messageParser->parseVarInt(data, offset + needle);
+
+                if (!varIntLen)
+                    return;
+
+                needle += varIntLen;
+
+                if (offset + needle > data.size() || nVers > (data.size() - offset - needle) / sizeof(uint32_t))
+                    return;
+
+                m_queryVersions.resize(nVers);
+
+                for (size_t i = 0; i < nVers; ++i) {
+                    std::memcpy(&m_queryVersions[i], &data.at(offset + needle + (i * sizeof(uint32_t))), sizeof(uint32_t));
+                }
+
+                needle += nVers * sizeof(uint32_t);
+            }
+        }
+
         if (data.at(offset + needle) != HW_MESSAGE_MAGIC_END)
             return;
 
@@ -48,7 +94,8 @@ CHandshakeProtocolsMessage::CHandshakeProtocolsMessage(const std::vector<uint8_t
     } catch (std::out_of_range& e) { m_len = 0; }
 }
 
-CHandshakeProtocolsMessage::CHandshakeProtocolsMessage(const std::vector<std::string>& protocols) {
+CHandshakeProtocolsMessage::CHandshakeProtocolsMessage(const std::vector<std::string>& protocols, std::optional<uint32_t> features,
+                                                       const std::optional<std::vector<uint32_t>>& queryVersions) {
     m_type = HW_MESSAGE_TYPE_HANDSHAKE_PROTOCOLS;
 
     m_data = {
@@ -64,5 +111,28 @@ CHandshakeProtocolsMessage::CHandshakeProtocolsMessage(const std::vector<std::st
         m_data.append_range(p);
     }
 
+    if (features) {
+        m_features = *features;
+        m_data.emplace_back(HW_MESSAGE_MAGIC_TYPE_UINT);
+        m_data.resize(m_data.size() + 4);
+        std::memcpy(&m_data[m_data.size() - 4], &m_features, sizeof(m_features));
+
+        if (queryVersions) {
+            m_queryVersions = *queryVersions;
+
+            m_data.emplace_back(HW_MESSAGE_MAGIC_TYPE_ARRAY);
+            m_data.emplace_back(HW_MESSAGE_MAGIC_TYPE_UINT);
+            m_data.append_range(g_messageParser->encodeVarInt(m_queryVersions.size()));
+
+            const size_t HEAD_SIZE = m_data.size();
+
+            m_data.resize(HEAD_SIZE + (m_queryVersions.size() * 4));
+
+            for (size_t i = 0; i < m_queryVersions.size(); ++i) {
+                std::memcpy(&m_data[HEAD_SIZE + (i * 4)], &m_queryVersions[i], sizeof(uint32_t));
+            }
+        }
+    }
+
     m_data.emplace_back(HW_MESSAGE_MAGIC_END);
 }
@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <cstdint>
+#include <optional>
 
 #include "IMessage.hpp"
 
@@ -9,10 +10,13 @@ namespace Hyprwire {
     class CHandshakeProtocolsMessage : public IMessage {
       public:
         CHandshakeProtocolsMessage(const std::vector<uint8_t>& data, size_t offset);
-        CHandshakeProtocolsMessage(const std::vector<std::string>& protocols);
+        CHandshakeProtocolsMessage(const std::vector<std::string>& protocols, std::optional<uint32_t> features = std::nullopt,
+                                   const std::optional<std::vector<uint32_t>>& queryVersions = std::nullopt);
 
         virtual ~CHandshakeProtocolsMessage() = default;
 
         std::vector<std::string> m_protocols;
+        uint32_t                 m_features = 0;
+        std::vector<uint32_t>    m_queryVersions;
     };
 };
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "IMessage.hpp"
+#include "GenericProtocolMessage.hpp"
 #include "../MessageParser.hpp"
+#include "../MessageMagic.hpp"
 #include "../../../helpers/Memory.hpp"
 
 #include <cstring>
@@ -33,6 +35,27 @@ static std::pair<std::string, size_t> formatPrimitiveType(const std::span<const
             std::memcpy(&val, &s[0], sizeof(val));
             return {std::format("{}", val), 4};
         }
+        case HW_MESSAGE_MAGIC_TYPE_U64: {
+            if (s.size() < 8)
+                return {"", 0};
+            uint64_t val = 0;
+            std::memcpy(&val, &s[0], sizeof(val));
+            return {std::format("{}", val), 8};
+        }
+        case HW_MESSAGE_MAGIC_TYPE_I64: {
+            if (s.size() < 8)
+                return {"", 0};
+            int64_t val = 0;
+            std::memcpy(&val, &s[0], sizeof(val));
+            return {std::format("{}", val), 8};
+        }
+        case HW_MESSAGE_MAGIC_TYPE_F64: {
+            if (s.size() < 8)
+                return {"", 0};
+            double val = 0;
+            std::memcpy(&val, &s[0], sizeof(val));
+            return {std::format("{}", val), 8};
+        }
         case HW_MESSAGE_MAGIC_TYPE_FD: {
             return {"<fd>", 0};
         }
@@ -59,6 +82,14 @@ std::string IMessage::parseData() const {
     result += messageTypeToStr(m_type);
     result += " ( ";
 
+    if (m_type == HW_MESSAGE_TYPE_COMPACT_PROTOCOL_MESSAGE) {
+        // the args have no magics, without the method there's no telling them apart
+        SCompactHeader header;
+        if (CGenericProtocolMessage::parseCompactHeader(m_data, header))
+            result += std::format("object: {}, method: {}, {} bytes{}", header.object, header.method, header.size, header.fds ? std::format(", {} fds", header.fds) : "");
+        return result + " ) ";
+    }
+
     size_t needle = 1;
     while (needle < m_data.size()) {
         switch (sc<eMessageMagic>(m_data.at(needle++))) {
@@ -66,7 +97,7 @@ std::string IMessage::parseData() const {
                 break;
             }
             case HW_MESSAGE_MAGIC_TYPE_SEQ: {
-                int32_t seq = 0;
+                uint32_t seq = 0;
                 if (m_data.size() - needle >= 4) {
                     std::memcpy(&seq, &m_data.at(needle), 4);
                     result += std::format("seq: {}", seq);
@@ -101,9 +132,37 @@ std::string IMessage::parseData() const {
                 }
                 break;
             }
+            case HW_MESSAGE_MAGIC_TYPE_U64:
+            case HW_MESSAGE_MAGIC_TYPE_I64:
+            case HW_MESSAGE_MAGIC_TYPE_F64: {
+                auto [str, len] = formatPrimitiveType(std::span<const uint8_t>{m_data.data() + needle, m_data.size() - needle}, sc<eMessageMagic>(m_data.at(needle - 1)));
+                result += str;
+                needle += len;
+                break;
+            }
+            case HW_MESSAGE_MAGIC_TYPE_OBJECT_ID: {
+                uint32_t id = 0;
+                if (m_data.size() - needle >= 4) {
+                    std::memcpy(&id, &m_data.at(needle), 4);
+                    result += std::format("object_id: {}", id == 0 ? "null" : std::to_string(id));
+                    needle += 4;
+                }
+                break;
+            }
+            case HW_MESSAGE_MAGIC_TYPE_STREAM: {
+                uint32_t id = 0;
+                if (m_data.size() - needle >= 4) {
+                    std::memcpy(&id, &m_data.at(needle), 4);
+                    result += std::format("stream: {}", id);
+                    needle += 4;
+                }
+                break;
+            }
             case HW_MESSAGE_MAGIC_TYPE_VARCHAR: {
                 auto [len, intLen] = g_messageParser->parseVarInt(m_data, needle);
-                if (len > 0) {
+                if (m_type == HW_MESSAGE_TYPE_STREAM_DATA)
+                    result += std::format("<{} bytes>", len);
+                else if (len > 0) {
                     auto ptr = rc<const char*>(&m_data.at(needle + intLen));
                     result += std::format("\"{}\"", std::string_view{ptr, len});
                 } else
@@ -111,12 +170,38 @@ std::string IMessage::parseData() const {
                 needle += intLen + len;
                 break;
             }
-            case HW_MESSAGE_MAGIC_TYPE_ARRAY: {
-                auto thisType      = sc<eMessageMagic>(m_data.at(needle++));
-                auto [els, intLen] = g_messageParser->parseVarInt(m_data, needle);
+            case HW_MESSAGE_MAGIC_TYPE_VARCHAR_REF: {
+                auto [id, intLen] = g_messageParser->parseVarInt(m_data, needle);
+                result += std::format("string: {}", id);
+                needle += intLen;
+                break;
+            }
+            case HW_MESSAGE_MAGIC_TYPE_ARRAY:
+            case HW_MESSAGE_MAGIC_TYPE_ALIGNED_ARRAY: {
+                const bool ALIGNED  = m_data.at(needle - 1) == HW_MESSAGE_MAGIC_TYPE_ALIGNED_ARRAY;
+                auto       thisType = sc<eMessageMagic>(m_data.at(needle++));
+                auto [els, intLen]  = g_messageParser->parseVarInt(m_data, needle);
                 result += "{ ";
                 needle += intLen;
 
+                if (ALIGNED)
+                    needle += 1 + m_data.at(needle);
+
+                if (thisType == HW_MESSAGE_MAGIC_TYPE_STRUCT) {
+                    auto [size, sizeLen] = g_messageParser->parseVarInt(m_data, needle);
+                    result += std::format("{} structs of {} bytes }}", els, size);
+                    needle += sizeLen + els * size;
+                    break;
+                }
+
+                if (thisType == HW_MESSAGE_MAGIC_TYPE_PACKED) {
+                    const auto elType    = sc<eMessageMagic>(m_data.at(needle));
+                    auto [size, sizeLen] = g_messageParser->parseVarInt(m_data, needle + 2);
+                    result += std::format("{} packed {} els, {} bytes }}", els, magicToString(elType), size);
+                    needle += 2 + sizeLen + size;
+                    break;
+                }
+
                 for (size_t i = 0; i < els; ++i) {
                     auto [str, len] = formatPrimitiveType(std::span<const uint8_t>{m_data.data() + (needle * sizeof(uint8_t)), m_data.size() - needle}, thisType);
 
@@ -145,6 +230,12 @@ std::string IMessage::parseData() const {
                 result += "<fd>";
                 break;
             }
+            case HW_MESSAGE_MAGIC_TYPE_CACHED_FD: {
+                auto [id, intLen] = g_messageParser->parseVarInt(m_data, needle);
+                result += std::format("fd: {}", id);
+                needle += intLen;
+                break;
+            }
             default: break;
         }
 
@@ -164,6 +255,31 @@ std::string IMessage::parseData() const {
     return result;
 }
 
+std::vector<uint8_t> IMessage::framed() const {
+    std::vector<uint8_t> header;
+    header.emplace_back(HW_MESSAGE_TYPE_FRAME);
+    g_messageParser->appendVarInt(header, m_data.size());
+    g_messageParser->appendVarInt(header, fds().size());
+
+    std::vector<uint8_t> data;
+    data.reserve(m_data.size() + 8);
+
+    // every HW_MAX_FDS_PER_SENDMSG fds go with a byte of their own (see sendWithFds), a PADDING frame in front makes up for missing ones
+    const size_t BATCHES = (fds().size() + HW_MAX_FDS_PER_SENDMSG - 1) / HW_MAX_FDS_PER_SENDMSG;
+    const size_t SIZE    = header.size() + m_data.size();
+    if (BATCHES > SIZE) {
+        data.emplace_back(HW_MESSAGE_TYPE_FRAME);
+        g_messageParser->appendVarInt(data, BATCHES - SIZE);
+        g_messageParser->appendVarInt(data, 0);
+        data.emplace_back(HW_MESSAGE_TYPE_PADDING);
+        data.resize(data.size() + BATCHES - SIZE - 1);
+    }
+
+    data.append_range(header);
+    data.append_range(m_data);
+    return data;
+}
+
 const std::vector<int>& IMessage::fds() const {
     static const std::vector<int> emptyVec;
     return emptyVec;
@@ -20,6 +20,9 @@ namespace Hyprwire {
 
         std::string                     parseData() const;
 
+        // m_data in a FRAME, for connections with HW_PROTOCOL_FEATURE_FRAMES
+        std::vector<uint8_t>            framed() const;
+
       protected:
         IMessage() = default;
     };
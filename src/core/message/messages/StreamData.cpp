@@ -0,0 +1,65 @@
+#include "StreamData.hpp"
+#include "../MessageType.hpp"
+#include "../MessageParser.hpp"
+#include "../../../helpers/Env.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <hyprwire/core/types/MessageMagic.hpp>
+
+using namespace Hyprwire;
+
+CStreamDataMessage::CStreamDataMessage(const std::vector<uint8_t>& data, size_t offset) {
+    m_type = HW_MESSAGE_TYPE_STREAM_DATA;
+
+    try {
+        if (data.at(offset + 0) != HW_MESSAGE_TYPE_STREAM_DATA)
+            return;
+
+        if (data.at(offset + 1) != HW_MESSAGE_MAGIC_TYPE_UINT)
+            return;
+
+        if ((data.size() - offset - 2) < sizeof(m_stream))
+            return;
+
+        std::memcpy(&m_stream, &data.at(offset + 2), sizeof(m_stream));
+
+        if (data.at(offset + 6) != HW_MESSAGE_MAGIC_TYPE_VARCHAR)
+            return;
+
+        size_t needle = 7;
+
+        auto [len, varIntLen] = g_messageParser->parseVarInt(data, offset + needle);
+
+        if (!varIntLen)
+            return;
+
+        needle += varIntLen;
+
+        if (len > data.size() - offset - needle)
+            return;
+
+        if (data.at(offset + needle + len) != HW_MESSAGE_MAGIC_END)
+            return;
+
+        m_chunk = std::span<const uint8_t>{&data.at(offset + needle), len};
+
+        m_len = needle + len + 1;
+
+        if (Env::isTrace())
+            m_data = std::vector<uint8_t>{data.begin() + offset, data.begin() + offset + m_len - 1};
+
+    } catch (std::out_of_range& e) { m_len = 0; }
+}
+
+CStreamDataMessage::CStreamDataMessage(uint32_t stream, std::span<const uint8_t> chunk) : m_stream(stream) {
+    m_type = HW_MESSAGE_TYPE_STREAM_DATA;
+
+    m_data = {HW_MESSAGE_TYPE_STREAM_DATA, HW_MESSAGE_MAGIC_TYPE_UINT, 0, 0, 0, 0, HW_MESSAGE_MAGIC_TYPE_VARCHAR};
+
+    std::memcpy(&m_data[2], &stream, sizeof(stream));
+
+    m_data.append_range(g_messageParser->encodeVarInt(chunk.size()));
+    m_data.append_range(chunk);
+    m_data.emplace_back(HW_MESSAGE_MAGIC_END);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <span>
+
+#include "IMessage.hpp"
+
+namespace Hyprwire {
+    class CStreamDataMessage : public IMessage {
+      public:
+        CStreamDataMessage(const std::vector<uint8_t>& data, size_t offset);
+        CStreamDataMessage(uint32_t stream, std::span<const uint8_t> chunk);
+
+        virtual ~CStreamDataMessage() = default;
+
+        uint32_t                 m_stream = 0;
+
+        // points into the parsed buffer. Empty = end of the stream.
+        std::span<const uint8_t> m_chunk;
+    };
+};
@@ -0,0 +1,66 @@
+#include "StringDefine.hpp"
+#include "../MessageType.hpp"
+#include "../MessageParser.hpp"
+#include "../../../helpers/Env.hpp"
+#include "../../../helpers/Memory.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <hyprwire/core/types/MessageMagic.hpp>
+
+using namespace Hyprwire;
+
+CStringDefineMessage::CStringDefineMessage(const std::vector<uint8_t>& data, size_t offset) {
+    m_type = HW_MESSAGE_TYPE_STRING_DEFINE;
+
+    try {
+        if (data.at(offset + 0) != HW_MESSAGE_TYPE_STRING_DEFINE)
+            return;
+
+        if (data.at(offset + 1) != HW_MESSAGE_MAGIC_TYPE_UINT)
+            return;
+
+        if ((data.size() - offset - 2) < sizeof(m_id))
+            return;
+
+        std::memcpy(&m_id, &data.at(offset + 2), sizeof(m_id));
+
+        if (data.at(offset + 6) != HW_MESSAGE_MAGIC_TYPE_VARCHAR)
+            return;
+
+        size_t needle = 7;
+
+        auto [len, varIntLen] = g_messageParser->parseVarInt(data, offset + needle);
+
+        if (!varIntLen)
+            return;
+
+        needle += varIntLen;
+
+        if (len > data.size() - offset - needle)
+            return;
+
+        if (data.at(offset + needle + len) != HW_MESSAGE_MAGIC_END)
+            return;
+
+        m_str = std::string_view{rc<const char*>(&data.at(offset + needle)), len};
+
+        m_len = needle + len + 1;
+
+        if (Env::isTrace())
+            m_data = std::vector<uint8_t>{data.begin() + offset, data.begin() + offset + m_len - 1};
+
+    } catch (std::out_of_range& e) { m_len = 0; }
+}
+
+CStringDefineMessage::CStringDefineMessage(uint32_t id, std::string_view str) : m_id(id) {
+    m_type = HW_MESSAGE_TYPE_STRING_DEFINE;
+
+    m_data = {HW_MESSAGE_TYPE_STRING_DEFINE, HW_MESSAGE_MAGIC_TYPE_UINT, 0, 0, 0, 0, HW_MESSAGE_MAGIC_TYPE_VARCHAR};
+
+    std::memcpy(&m_data[2], &id, sizeof(id));
+
+    m_data.append_range(g_messageParser->encodeVarInt(str.size()));
+    m_data.append_range(str);
+    m_data.emplace_back(HW_MESSAGE_MAGIC_END);
+}
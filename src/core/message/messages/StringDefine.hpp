@@ -0,0 +1,22 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <string_view>
+
+#include "IMessage.hpp"
+
+namespace Hyprwire {
+    class CStringDefineMessage : public IMessage {
+      public:
+        CStringDefineMessage(const std::vector<uint8_t>& data, size_t offset);
+        CStringDefineMessage(uint32_t id, std::string_view str);
+
+        virtual ~CStringDefineMessage() = default;
+
+        uint32_t         m_id = 0;
+
+        // points into the parsed buffer
+        std::string_view m_str;
+    };
+};
@@ -5,6 +5,7 @@
 #include "../message/messages/NewObject.hpp"
 #include "../message/messages/GenericProtocolMessage.hpp"
 #include "../../helpers/Log.hpp"
+#include "../../helpers/Defines.hpp"
 #include "../../Macros.hpp"
 
 #include <hyprwire/core/implementation/ServerImpl.hpp>
@@ -12,8 +13,16 @@
 
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include <algorithm>
 
 using namespace Hyprwire;
+using namespace Hyprutils::OS;
 
 CServerClient::CServerClient(int fd) : m_fd(fd) {
     m_fd.setFlags(O_CLOEXEC);
@@ -21,6 +30,10 @@ CServerClient::CServerClient(int fd) : m_fd(fd) {
 
 CServerClient::~CServerClient() {
     TRACE(Debug::log(TRACE, "[{}] destroying client", m_fd.get()));
+
+    // last chance for a queued fatal error, the socket closes right after
+    if (hasOutgoing())
+        flushOutgoing();
 }
 
 void CServerClient::dispatchFirstPoll() {
@@ -48,56 +61,225 @@ void CServerClient::dispatchFirstPoll() {
 
 void CServerClient::sendMessage(const IMessage& message) {
     TRACE(Debug::log(TRACE, "[{} @ {:.3f}] -> {}", m_fd.get(), steadyMillis(), message.parseData()));
-    // NOLINTNEXTLINE
-    msghdr      msg = {0}; // NOLINTNEXTLINE
-    iovec       io  = {0};
 
-    const auto& FDS = message.fds();
+    if (!m_fd.isValid())
+        return;
+
+    // the client learns whether it got frames from HANDSHAKE_PROTOCOLS, so that one goes out as is
+    if ((m_features & HW_PROTOCOL_FEATURE_FRAMES) && message.m_type != HW_MESSAGE_TYPE_HANDSHAKE_PROTOCOLS)
+        sendData(message, message.framed());
+    else
+        sendData(message, message.m_data);
+}
+
+void CServerClient::sendData(const IMessage& message, const std::vector<uint8_t>& data) {
+    // something is already waiting, keep the order
+    if (hasOutgoing()) {
+        queueMessage(message, data, 0);
+        flushOutgoing();
+        return;
+    }
+
+    const auto RET = writeData(data, 0, message.fds());
+
+    if (RET >= 0 && sc<size_t>(RET) == data.size())
+        return;
+
+    if (RET < 0 && errno != EWOULDBLOCK && errno != EAGAIN) {
+        TRACE(Debug::log(TRACE, "[{} @ {:.3f}] sendmsg failed: {}", m_fd.get(), steadyMillis(), strerror(errno)));
+        return;
+    }
+
+    // the client is slow, keep the rest for later. Fds go out with the first bytes, see sendWithFds.
+    queueMessage(message, data, RET < 0 ? 0 : RET);
+}
 
-    // fucking evil!
-    io.iov_base    = cc<void*>(rc<const void*>(message.m_data.data()));
-    io.iov_len     = message.m_data.size();
-    msg.msg_iov    = &io;
-    msg.msg_iovlen = 1;
+ssize_t CServerClient::writeData(std::span<const uint8_t> data, size_t offset, const std::vector<int>& fds) {
+    return sendWithFds(m_fd, data, offset, fds, MSG_DONTWAIT | MSG_NOSIGNAL);
+}
+
+const SMethod* CServerClient::outgoingMethod(uint32_t object, uint32_t method) {
+    const auto OBJ = objectForId(object);
+    if (!OBJ)
+        return nullptr;
+
+    const auto& METHODS = OBJ->methodsOut();
+    return method < METHODS.size() ? &METHODS.at(method) : nullptr;
+}
+
+SP<CServerObject> CServerClient::objectForId(uint32_t id) {
+    const auto IT = m_objectsById.find(id);
+    return IT == m_objectsById.end() ? nullptr : IT->second.lock();
+}
+
+bool CServerClient::queuedFor(eOutgoingLane lane, uint32_t object) {
+    return std::ranges::any_of(m_outgoing.at(lane), [object](const auto& q) { return q.object == object; });
+}
 
-    std::vector<uint8_t> controlBuf;
+void CServerClient::queueMessage(const IMessage& message, const std::vector<uint8_t>& data, size_t written) {
+    const bool WAS_EMPTY = !hasOutgoing();
 
-    if (!FDS.empty()) {
-        controlBuf.resize(CMSG_SPACE(sizeof(int) * FDS.size()));
+    SOutgoingMessage out;
+    out.offset = written;
 
-        msg.msg_control    = controlBuf.data();
-        msg.msg_controllen = controlBuf.size();
+    eOutgoingLane lane = HW_OUTGOING_LANE_BULK;
 
-        cmsghdr* cmsg    = CMSG_FIRSTHDR(&msg);
-        cmsg->cmsg_level = SOL_SOCKET;
-        cmsg->cmsg_type  = SCM_RIGHTS;
-        cmsg->cmsg_len   = CMSG_LEN(sizeof(int) * FDS.size());
+    switch (message.m_type) {
+        // ROUNDTRIP_DONE stays in order: it promises everything before it was sent. So does a fatal error, the client
+        // should see what happened before it.
+        case HW_MESSAGE_TYPE_NEW_OBJECT: lane = HW_OUTGOING_LANE_CONTROL; break;
+        case HW_MESSAGE_TYPE_GENERIC_PROTOCOL_MESSAGE:
+        case HW_MESSAGE_TYPE_COMPACT_PROTOCOL_MESSAGE: {
+            if (message.m_type == HW_MESSAGE_TYPE_COMPACT_PROTOCOL_MESSAGE) {
+                SCompactHeader header;
+                if (!CGenericProtocolMessage::parseCompactHeader(message.m_data, header))
+                    break;
 
-        int* data = rc<int*>(CMSG_DATA(cmsg));
-        for (size_t i = 0; i < FDS.size(); ++i) {
-            data[i] = FDS.at(i);
+                out.object = header.object;
+                out.method = header.method;
+            } else {
+                if (message.m_data.size() < 11)
+                    break;
+
+                std::memcpy(&out.object, &message.m_data[2], sizeof(out.object));
+                std::memcpy(&out.method, &message.m_data[7], sizeof(out.method));
+            }
+
+            const auto METHOD = outgoingMethod(out.object, out.method);
+            if (!METHOD)
+                break;
+
+            out.coalesce = written == 0 && METHOD->coalesce == HW_METHOD_COALESCE_LATEST;
+
+            // don't overtake older events on the same object
+            if (METHOD->priority == HW_METHOD_PRIORITY_HIGH && !queuedFor(HW_OUTGOING_LANE_BULK, out.object))
+                lane = HW_OUTGOING_LANE_CONTROL;
+            break;
         }
+        default: break;
+    }
+
+    auto&                        queue = m_outgoing.at(lane);
+    std::vector<CFileDescriptor> fds;
+    // the caller may close its fds once we return. A large batch may not have gone out fully yet, sendWithFds skips the sent ones.
+    for (const auto& fd : message.fds()) {
+        fds.emplace_back(fcntl(fd, F_DUPFD_CLOEXEC, 0));
+    }
+
+    if (out.coalesce) {
+        for (auto& q : queue) {
+            if (!q.coalesce || q.offset != 0 || q.object != out.object || q.method != out.method)
+                continue;
+
+            TRACE(Debug::log(TRACE, "[{} @ {:.3f}] coalescing queued method {} for object {}", m_fd.get(), steadyMillis(), out.method, out.object));
+
+            m_outgoingBytes += data.size() - q.data.size();
+
+            q.data = data;
+            q.fds  = std::move(fds);
+            return;
+        }
+    }
+
+    if (m_outgoingBytes + data.size() - written > HW_MAX_OUTGOING_BYTES) {
+        disconnectSlow();
+        return;
+    }
+
+    m_outgoingBytes += data.size() - written;
+
+    out.data = data;
+    out.fds  = std::move(fds);
+    queue.emplace_back(std::move(out));
+
+    TRACE(Debug::log(TRACE, "[{} @ {:.3f}] client is slow, {} control and {} bulk messages queued", m_fd.get(), steadyMillis(), m_outgoing.at(HW_OUTGOING_LANE_CONTROL).size(),
+                     m_outgoing.at(HW_OUTGOING_LANE_BULK).size()));
+
+    // let the poller know it should wait for POLLOUT on us
+    if (WAS_EMPTY && m_server && m_server->m_wakeupWriteFd.isValid())
+        sc<void>(write(m_server->m_wakeupWriteFd.get(), "x", 1));
+}
+
+void CServerClient::disconnectSlow() {
+    Debug::log(ERR, "[{} @ {:.3f}] client isn't reading, {} bytes queued. Disconnecting", m_fd.get(), steadyMillis(), m_outgoingBytes);
+
+    for (auto& q : m_outgoing) {
+        q.clear();
     }
 
-    while (m_fd.isValid()) {
-        int ret = sendmsg(m_fd.get(), &msg, 0);
-        if (ret < 0 && (errno == EWOULDBLOCK || errno == EAGAIN)) {
-            pollfd pfd = {
-                .fd     = m_fd.get(),
-                .events = POLLOUT | POLLWRBAND,
-            };
-            poll(&pfd, 1, -1);
-        } else
+    m_outgoingBytes = 0;
+    m_error         = true;
+
+    // we get a hangup for it on the next dispatch, and drop the client then
+    shutdown(m_fd.get(), SHUT_RDWR);
+}
+
+bool CServerClient::flushOutgoing() {
+    auto& control = m_outgoing.at(HW_OUTGOING_LANE_CONTROL);
+    auto& bulk    = m_outgoing.at(HW_OUTGOING_LANE_BULK);
+
+    while (hasOutgoing() && m_fd.isValid()) {
+        // lanes switch only at message boundaries
+        auto& queue = !bulk.empty() && (bulk.front().offset > 0 || control.empty()) ? bulk : control;
+        auto& front = queue.front();
+
+        std::vector<int> fds;
+        for (const auto& fd : front.fds) {
+            fds.emplace_back(fd.get());
+        }
+
+        const auto RET = writeData(front.data, front.offset, fds);
+
+        if (RET < 0) {
+            if (errno == EWOULDBLOCK || errno == EAGAIN)
+                break;
+
+            TRACE(Debug::log(TRACE, "[{} @ {:.3f}] sendmsg failed: {}, dropping queued messages", m_fd.get(), steadyMillis(), strerror(errno)));
+            control.clear();
+            bulk.clear();
+            m_outgoingBytes = 0;
+            break;
+        }
+
+        front.offset += RET;
+        m_outgoingBytes -= RET;
+
+        if (front.offset < front.data.size())
             break;
+
+        queue.pop_front();
     }
+
+    // streams that stopped at a full queue can go on
+    if (m_outgoingBytes < HW_STREAM_MAX_QUEUED_BYTES)
+        m_streams.drained();
+
+    return hasOutgoing();
+}
+
+bool CServerClient::hasOutgoing() {
+    return std::ranges::any_of(m_outgoing, [](const auto& q) { return !q.empty(); });
 }
 
 SP<CServerObject> CServerClient::createObject(const std::string& protocol, const std::string& object, uint32_t version, uint32_t seq) {
-    auto obj       = makeShared<CServerObject>(m_self.lock());
-    obj->m_id      = m_maxId++;
+    auto obj = makeShared<CServerObject>(m_self.lock());
+
+    if (m_features & HW_PROTOCOL_FEATURE_CLIENT_IDS) {
+        // the client already picked the id, it's the seq.
+        if (seq < HW_CLIENT_ID_BASE || objectForId(seq)) {
+            Debug::log(ERR, "[{} @ {:.3f}] Error: createObject with invalid client id {}", m_fd.get(), steadyMillis(), seq);
+            m_error = true;
+            return nullptr;
+        }
+
+        obj->m_id = seq;
+    } else
+        obj->m_id = m_maxId++;
+
     obj->m_self    = obj;
     obj->m_version = version;
     m_objects.emplace_back(obj);
+    m_objectsById[obj->m_id] = obj;
 
     for (const auto& p : m_server->m_impls) {
         if (p->protocol()->specName() != protocol)
@@ -135,8 +317,10 @@ SP<CServerObject> CServerClient::createObject(const std::string& protocol, const
         return nullptr;
     }
 
-    auto ret = CNewObjectMessage(seq, obj->m_id);
-    sendMessage(ret);
+    if (!(m_features & HW_PROTOCOL_FEATURE_CLIENT_IDS)) {
+        auto ret = CNewObjectMessage(seq, obj->m_id);
+        sendMessage(ret);
+    }
 
     onBind(obj);
 
@@ -162,16 +346,59 @@ void CServerClient::onBind(SP<CServerObject> obj) {
 }
 
 void CServerClient::onGeneric(const CGenericProtocolMessage& msg) {
-    for (const auto& o : m_objects) {
-        if (o->m_id == msg.m_object) {
-            o->called(msg.m_method, msg.m_dataSpan, msg.m_fds);
-            return;
-        }
+    // runs of calls to the same object are common, skip the lookup for those
+    if (m_batch.object && m_batch.object->m_id == msg.m_object) {
+        auto obj = m_batch.object.lock();
+
+        if (m_batch.method != msg.m_method)
+            flushBatch();
+
+        dispatchCall(obj, msg);
+        return;
+    }
+
+    flushBatch();
+
+    if (const auto OBJ = objectForId(msg.m_object)) {
+        dispatchCall(OBJ, msg);
+        return;
     }
 
     Debug::log(WARN, "[{} @ {:.3f}] -> Generic message not handled. No object with id {}!", m_fd.get(), steadyMillis(), msg.m_object);
 }
 
+void CServerClient::onEventInterest(uint32_t id, std::vector<uint32_t>&& mask) {
+    if (const auto OBJ = objectForId(id)) {
+        OBJ->m_interest = std::move(mask);
+        return;
+    }
+
+    // might have been destroyed already
+    TRACE(Debug::log(TRACE, "[{} @ {:.3f}] -> Event interest for unknown object {}", m_fd.get(), steadyMillis(), id));
+}
+
+void CServerClient::dispatchCall(SP<CServerObject> obj, const CGenericProtocolMessage& msg) {
+    obj->called(msg.m_method, msg.m_dataSpan, msg.m_args, msg.m_fds, msg.m_compact);
+
+    if (obj->m_batchDone.size() > msg.m_method && obj->m_batchDone.at(msg.m_method)) {
+        m_batch.object = obj;
+        m_batch.method = msg.m_method;
+    }
+}
+
+void CServerClient::flushBatch() {
+    if (!m_batch.object)
+        return;
+
+    auto obj = m_batch.object.lock();
+    m_batch.object.reset();
+
+    if (obj->m_batchDone.size() <= m_batch.method || !obj->m_batchDone.at(m_batch.method))
+        return;
+
+    rc<void (*)(IObject*)>(obj->m_batchDone.at(m_batch.method))(obj.get());
+}
+
 int CServerClient::getPID() {
     return m_pid;
 }
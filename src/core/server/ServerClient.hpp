@@ -2,15 +2,39 @@
 
 #include <hyprutils/os/FileDescriptor.hpp>
 #include <hyprwire/core/ServerSocket.hpp>
+#include <array>
 #include <cstdint>
+#include <deque>
+#include <span>
 #include <vector>
+#include <string>
+#include <unordered_map>
 #include "../../helpers/Memory.hpp"
+#include "../stream/StreamTable.hpp"
+#include "../strings/StringTable.hpp"
+#include "../fds/FdCache.hpp"
+#include "../socket/SocketHelpers.hpp"
 
 namespace Hyprwire {
     class IMessage;
     class CServerSocket;
     class CServerObject;
     class CGenericProtocolMessage;
+    struct SMethod;
+
+    enum eOutgoingLane : uint8_t {
+        HW_OUTGOING_LANE_CONTROL = 0, // NEW_OBJECT and priority="high" methods
+        HW_OUTGOING_LANE_BULK,
+        HW_OUTGOING_LANE_COUNT,
+    };
+
+    struct SOutgoingMessage {
+        std::vector<uint8_t>                        data;
+        std::vector<Hyprutils::OS::CFileDescriptor> fds;
+        size_t                                      offset = 0; // bytes already written
+        uint32_t                                    object = 0, method = 0;
+        bool                                        coalesce = false;
+    };
 
     class CServerClient : public IServerClient {
       public:
@@ -20,9 +44,21 @@ namespace Hyprwire {
         virtual int                    getPID();
 
         void                           sendMessage(const IMessage& message);
+        void                           sendData(const IMessage& message, const std::vector<uint8_t>& data);
+        bool                           flushOutgoing();
+        bool                           hasOutgoing();
+        ssize_t                        writeData(std::span<const uint8_t> data, size_t offset, const std::vector<int>& fds);
+        void                           queueMessage(const IMessage& message, const std::vector<uint8_t>& data, size_t written);
+        const SMethod*                 outgoingMethod(uint32_t object, uint32_t method);
+        SP<CServerObject>              objectForId(uint32_t id);
+        bool                           queuedFor(eOutgoingLane lane, uint32_t object);
+        void                           disconnectSlow();
         SP<CServerObject>              createObject(const std::string& protocol, const std::string& object, uint32_t version, uint32_t seq);
         void                           onBind(SP<CServerObject> obj);
         void                           onGeneric(const CGenericProtocolMessage& msg);
+        void                           onEventInterest(uint32_t id, std::vector<uint32_t>&& mask);
+        void                           dispatchCall(SP<CServerObject> obj, const CGenericProtocolMessage& msg);
+        void                           flushBatch();
         void                           dispatchFirstPoll();
 
         Hyprutils::OS::CFileDescriptor m_fd;
@@ -31,12 +67,34 @@ namespace Hyprwire {
         bool                           m_firstPollDone = false;
 
         uint32_t                       m_version = 0, m_maxId = 1;
-        bool                           m_error = false;
-
-        uint32_t                       m_scheduledRoundtripSeq = 0;
+        uint32_t                       m_features = 0;
+        bool                           m_error    = false;
 
         std::vector<SP<CServerObject>> m_objects;
 
+        // m_objects by id, for the per-message lookups
+        std::unordered_map<uint32_t, WP<CServerObject>> m_objectsById;
+
+        // protocol query from the handshake, binds by index refer to this
+        std::vector<std::string>       m_queriedProtocols;
+
+        // the run of batched calls being collected, see IObject::listenBatch
+        struct {
+            WP<CServerObject> object;
+            uint32_t          method = 0;
+        } m_batch;
+
+        CStreamTable                   m_streams;
+        CStringTable                   m_strings;
+        CFdCache                       m_fdCache;
+
+        // the start of a FRAME that didn't fully arrive yet, and the fds that came with it
+        SSocketRawParsedMessage        m_partialRead;
+
+        // messages the socket didn't take yet, flushed on POLLOUT, control lane first
+        std::array<std::deque<SOutgoingMessage>, HW_OUTGOING_LANE_COUNT> m_outgoing;
+        size_t                                                           m_outgoingBytes = 0;
+
         WP<CServerSocket>              m_server;
         WP<CServerClient>              m_self;
     };
@@ -3,6 +3,7 @@
 #include "ServerSocket.hpp"
 #include "../../helpers/Log.hpp"
 #include "../../Macros.hpp"
+#include "../../helpers/Defines.hpp"
 #include "../message/MessageType.hpp"
 #include "../message/MessageParser.hpp"
 #include "../message/messages/GenericProtocolMessage.hpp"
@@ -65,3 +66,45 @@ void CServerObject::error(uint32_t id, const std::string_view& message) {
     m_client->sendMessage(msg);
     errd();
 }
+
+bool CServerObject::interested(uint32_t id) {
+    if (!m_interest)
+        return true;
+
+    return id / 32 < m_interest->size() && (m_interest->at(id / 32) & (1U << (id % 32)));
+}
+
+bool CServerObject::alignedArrays() {
+    return m_client && (m_client->m_features & HW_PROTOCOL_FEATURE_ALIGNED_ARRAYS);
+}
+
+bool CServerObject::compact() {
+    return m_client && m_client->m_version >= HW_PROTOCOL_VER_COMPACT;
+}
+
+bool CServerObject::outgoingFull() {
+    return m_client && m_client->m_outgoingBytes >= HW_STREAM_MAX_QUEUED_BYTES;
+}
+
+CStreamTable* CServerObject::streams() {
+    return m_client ? &m_client->m_streams : nullptr;
+}
+
+CStringTable* CServerObject::strings() {
+    return m_client && (m_client->m_features & HW_PROTOCOL_FEATURE_STRING_TABLE) ? &m_client->m_strings : nullptr;
+}
+
+CFdCache* CServerObject::fdCache() {
+    return m_client && (m_client->m_features & HW_PROTOCOL_FEATURE_FD_CACHE) ? &m_client->m_fdCache : nullptr;
+}
+
+IWireObject* CServerObject::connectionObject(uint32_t id) {
+    if (!m_client)
+        return nullptr;
+
+    return m_client->objectForId(id).get();
+}
+
+bool CServerObject::sameConnection(IWireObject* other) {
+    return other->server() == server() && sc<CServerObject*>(other)->m_client.lock() == m_client.lock();
+}
@@ -7,6 +7,8 @@
 #include "../../helpers/Memory.hpp"
 #include "../wireObject/IWireObject.hpp"
 
+#include <optional>
+
 namespace Hyprwire {
     class CServerClient;
 
@@ -25,7 +27,19 @@ namespace Hyprwire {
         virtual Hyprutils::Memory::CSharedPointer<IServerSocket> serverSock();
         virtual bool                                             server();
         virtual void                                             error(uint32_t id, const std::string_view& message);
+        virtual bool                                             interested(uint32_t id);
+        virtual bool                                             alignedArrays();
+        virtual bool                                             compact();
+        virtual bool                                             outgoingFull();
+        virtual CStreamTable*                                    streams();
+        virtual CStringTable*                                    strings();
+        virtual CFdCache*                                        fdCache();
+        virtual IWireObject*                                     connectionObject(uint32_t id);
+        virtual bool                                             sameConnection(IWireObject* other);
 
         WP<CServerClient>                                        m_client;
+
+        // s2c methods the client listens to, bit per method id. Unset = everything.
+        std::optional<std::vector<uint32_t>>                     m_interest;
     };
 };
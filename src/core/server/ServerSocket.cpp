@@ -6,17 +6,26 @@
 #include "../../Macros.hpp"
 #include "../message/MessageParser.hpp"
 #include "../message/messages/FatalProtocolError.hpp"
-#include "../message/messages/RoundtripDone.hpp"
+#include "../message/messages/GenericProtocolMessage.hpp"
+#include "../message/MessageType.hpp"
 #include "../socket/SocketHelpers.hpp"
 
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <netinet/in.h>
 #include <cstring>
+#include <cstdarg>
 #include <cerrno>
 #include <unistd.h>
 
+#include <hyprwire/core/implementation/ServerImpl.hpp>
+#include <hyprwire/core/implementation/Spec.hpp>
+#include <hyprwire/core/types/MessageMagic.hpp>
+
 #include <filesystem>
+#include <algorithm>
+#include <array>
+#include <optional>
 #include <hyprutils/utils/ScopeGuard.hpp>
 
 using namespace Hyprwire;
@@ -142,6 +151,7 @@ void CServerSocket::addImplementation(SP<IProtocolServerImplementation>&& x) {
 }
 
 bool CServerSocket::dispatchPending() {
+    updateClientPollEvents();
     poll(m_pollfds.data(), m_pollfds.size(), 0);
     if (dispatchNewConnections())
         return dispatchPending();
@@ -162,6 +172,7 @@ bool CServerSocket::dispatchEvents(bool block) {
     clearWakeupFd();
 
     if (block) {
+        updateClientPollEvents();
         poll(m_pollfds.data(), m_pollfds.size(), -1);
         while (dispatchPending()) {
             ;
@@ -235,6 +246,21 @@ size_t CServerSocket::internalFds() {
     return m_isEmptyListener ? 2 : 3;
 }
 
+bool CServerSocket::protocolSupported(const std::string& name, uint32_t version) {
+    for (const auto& impl : m_impls) {
+        if (impl->protocol()->specName() == name)
+            return impl->protocol()->specVer() >= version;
+    }
+
+    return false;
+}
+
+void CServerSocket::updateClientPollEvents() {
+    for (size_t i = internalFds(); i < m_pollfds.size(); ++i) {
+        m_pollfds.at(i).events = POLLIN | (m_clients.at(i - internalFds())->hasOutgoing() ? POLLOUT : 0);
+    }
+}
+
 //
 void CServerSocket::recheckPollFds() {
     m_pollfds.clear();
@@ -288,6 +314,9 @@ bool CServerSocket::dispatchExistingConnections() {
     bool needsPollRecheck = false;
 
     for (size_t i = internalFds(); i < m_pollfds.size(); ++i) {
+        if (m_pollfds.at(i).revents & POLLOUT)
+            m_clients.at(i - internalFds())->flushOutgoing();
+
         if (!(m_pollfds.at(i).revents & POLLIN))
             continue;
 
@@ -333,11 +362,6 @@ void CServerSocket::dispatchClient(SP<CServerClient> client) {
         client->m_error = true;
         return;
     }
-
-    if (client->m_scheduledRoundtripSeq > 0) {
-        client->sendMessage(CRoundtripDoneMessage{client->m_scheduledRoundtripSeq});
-        client->m_scheduledRoundtripSeq = 0;
-    }
 }
 
 int CServerSocket::extractLoopFD() {
@@ -394,7 +418,7 @@ int CServerSocket::extractLoopFD() {
                 for (const auto& c : m_clients) {
                     pollfds.emplace_back(pollfd{
                         .fd     = c->m_fd.get(),
-                        .events = POLLIN,
+                        .events = sc<short>(POLLIN | (c->hasOutgoing() ? POLLOUT : 0)),
                     });
                 }
 
@@ -434,3 +458,125 @@ SP<IObject> CServerSocket::createObject(SP<IServerClient> clientIface, SP<IObjec
 
     return newObject;
 }
+
+void CServerSocket::broadcast(const std::vector<SP<IObject>>& targets, uint32_t method, ...) {
+    if (targets.empty())
+        return;
+
+    auto first = reinterpretPointerCast<CServerObject>(targets.front());
+    if (!first || !first->m_spec)
+        return;
+
+    const auto& METHODS = first->methodsOut();
+    if (METHODS.size() <= method) {
+        Debug::log(ERR, "core protocol error: broadcast: invalid method {} for object type {}", method, first->m_spec->objectName());
+        return;
+    }
+
+    const auto& METHOD = METHODS.at(method);
+
+    if (!METHOD.returnsType.empty()) {
+        Debug::log(ERR, "core protocol error: broadcast: server cannot call returnsType methods");
+        return;
+    }
+
+    if (!METHOD.objectTypes.empty()) {
+        Debug::log(ERR, "core protocol error: broadcast: object ids are per client, can't broadcast method {}", method);
+        return;
+    }
+
+    // encode once per format. v1 has a placeholder object id at offset 2, compact messages get their header per target.
+    va_list va;
+    va_start(va, method);
+
+    // one encoding for every v1 target, so only aligned if all of them take it.
+    // Compact ones can't say whether an array is padded, that follows each target's features.
+    const bool ALIGN = std::ranges::all_of(targets, [](const auto& t) {
+        auto obj = reinterpretPointerCast<CServerObject>(t);
+        return !obj || obj->compact() || obj->alignedArrays();
+    });
+
+    struct SEncoded {
+        bool                 done = false, ok = false;
+        std::vector<uint8_t> data;
+        std::vector<int>     fds;
+    };
+
+    // v1, compact, compact with aligned arrays
+    std::array<SEncoded, 3> encoded;
+
+    const auto ENCODE = [&](size_t format) -> SEncoded& {
+        auto& e = encoded.at(format);
+        if (e.done)
+            return e;
+
+        e.done = true;
+
+        if (format == 0) {
+            e.data.reserve(32);
+            e.data.emplace_back(HW_MESSAGE_TYPE_GENERIC_PROTOCOL_MESSAGE);
+            e.data.emplace_back(HW_MESSAGE_MAGIC_TYPE_OBJECT);
+            e.data.resize(e.data.size() + 4);
+            e.data.emplace_back(HW_MESSAGE_MAGIC_TYPE_UINT);
+            e.data.resize(e.data.size() + 4);
+            std::memcpy(&e.data[e.data.size() - 4], &method, sizeof(method));
+        }
+
+        // string ids are per connection, broadcasts send strings as they are
+        va_list copy;
+        va_copy(copy, va);
+        e.ok = first->encodeArgs(METHOD, copy, e.data, e.fds, format == 0 ? ALIGN : format == 2, format != 0, nullptr, nullptr, nullptr, nullptr);
+        va_end(copy);
+
+        if (format == 0)
+            e.data.emplace_back(HW_MESSAGE_MAGIC_END);
+
+        return e;
+    };
+
+    std::optional<CGenericProtocolMessage> v1;
+    const auto                             OBJECT_NAME = first->m_spec->objectName();
+    const auto                             PROTOCOL    = first->m_protocolName;
+
+    for (const auto& t : targets) {
+        auto obj = reinterpretPointerCast<CServerObject>(t);
+        if (!obj || !obj->m_client || !obj->m_id)
+            continue;
+
+        if (obj->m_spec != first->m_spec && (obj->m_protocolName != PROTOCOL || obj->m_spec->objectName() != OBJECT_NAME)) {
+            Debug::log(ERR, "core protocol error: broadcast: object {} is not of type {}, skipping", obj->m_id, OBJECT_NAME);
+            continue;
+        }
+
+        if (!obj->interested(method))
+            continue;
+
+        if (METHOD.since > obj->m_version) {
+            TRACE(Debug::log(TRACE, "[{}] broadcast: skipping object {}, method {} since {} but has {}", obj->m_client->m_fd.get(), obj->m_id, method, METHOD.since,
+                             obj->m_version));
+            continue;
+        }
+
+        if (obj->compact()) {
+            auto& e = ENCODE(obj->alignedArrays() ? 2 : 1);
+            if (!e.ok)
+                break;
+
+            obj->m_client->sendMessage(CGenericProtocolMessage(obj->m_id, method, e.data, std::vector<int>{e.fds}));
+            continue;
+        }
+
+        if (!v1) {
+            auto& e = ENCODE(0);
+            if (!e.ok)
+                break;
+
+            v1.emplace(std::move(e.data), std::move(e.fds));
+        }
+
+        std::memcpy(&v1->m_data[2], &obj->m_id, sizeof(obj->m_id));
+        obj->m_client->sendMessage(*v1);
+    }
+
+    va_end(va);
+}
@@ -27,8 +27,10 @@ namespace Hyprwire {
         virtual SP<IObject>                            createObject(SP<IServerClient> client, SP<IObject> reference, const std::string& object, uint32_t seq);
         virtual SP<IServerClient>                      addClient(int fd);
         virtual bool                                   removeClient(int fd);
+        virtual void                                   broadcast(const std::vector<SP<IObject>>& targets, uint32_t method, ...);
 
         void                                           recheckPollFds();
+        void                                           updateClientPollEvents();
         bool                                           dispatchNewConnections();
         bool                                           dispatchExistingConnections();
         bool                                           dispatchPending();
@@ -37,6 +39,7 @@ namespace Hyprwire {
         void                                           clearWakeupFd();
         void                                           clearFd(const Hyprutils::OS::CFileDescriptor& fd);
         size_t                                         internalFds();
+        bool                                           protocolSupported(const std::string& name, uint32_t version);
 
         std::vector<SP<IProtocolServerImplementation>> m_impls;
 
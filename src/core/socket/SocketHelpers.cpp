@@ -3,10 +3,14 @@
 #include "../../helpers/Log.hpp"
 #include "../../helpers/Memory.hpp"
 #include "../../Macros.hpp"
+#include "../../helpers/Defines.hpp"
 
 #include <unistd.h>
 #include <sys/socket.h>
 
+#include <array>
+#include <cerrno>
+#include <cstring>
 #include <span>
 #include <mutex>
 
@@ -15,13 +19,13 @@ using namespace Hyprwire;
 SSocketRawParsedMessage Hyprwire::parseFromFd(const Hyprutils::OS::CFileDescriptor& fd) {
     SSocketRawParsedMessage     message;
     constexpr size_t            BUFFER_SIZE         = 8192;
-    constexpr size_t            MAX_FDS_PER_MSG     = 255;
     static uint8_t              buffer[BUFFER_SIZE] = {0};
     static std::mutex           readMutex; // TODO: make the buffer per-socket and no need for a mtx
 
     std::lock_guard<std::mutex> lg(readMutex);
 
     ssize_t                     sizeWritten = 0;
+    bool                        gotFds      = false;
 
     do {
         // NOLINTNEXTLINE
@@ -33,39 +37,108 @@ SSocketRawParsedMessage Hyprwire::parseFromFd(const Hyprutils::OS::CFileDescript
         msg.msg_iov    = &io;
         msg.msg_iovlen = 1;
 
-        std::array<uint8_t, CMSG_SPACE(MAX_FDS_PER_MSG * sizeof(int))> controlBuf;
+        std::array<uint8_t, CMSG_SPACE(HW_MAX_FDS_PER_SENDMSG * sizeof(int))> controlBuf;
 
         msg.msg_control    = controlBuf.data();
         msg.msg_controllen = controlBuf.size();
 
-        sizeWritten = recvmsg(fd.get(), &msg, 0);
-        if (sizeWritten < 0)
+        // a read stops at the end of a sendmsg with fds, and a large batch of them comes in several. Only the first read may wait.
+        const bool MORE = sizeWritten > 0;
+        sizeWritten     = recvmsg(fd.get(), &msg, MORE ? MSG_DONTWAIT : 0);
+        if (sizeWritten < 0) {
+            if (MORE && (errno == EAGAIN || errno == EWOULDBLOCK))
+                break;
             return {.bad = true};
+        }
 
         message.data.append_range(std::span<uint8_t>(buffer, sizeWritten));
 
-        // check for control
-        cmsghdr* recvdCmsg = CMSG_FIRSTHDR(&msg);
-        if (!recvdCmsg)
-            continue;
+        gotFds = false;
+        for (cmsghdr* recvdCmsg = CMSG_FIRSTHDR(&msg); recvdCmsg; recvdCmsg = CMSG_NXTHDR(&msg, recvdCmsg)) {
+            if (recvdCmsg->cmsg_level != SOL_SOCKET || recvdCmsg->cmsg_type != SCM_RIGHTS) {
+                Debug::log(ERR, "protocol error on fd {}: invalid control message on wire of type {}", fd.get(), recvdCmsg->cmsg_type);
+                return {.bad = true};
+            }
+
+            int*   data        = rc<int*>(CMSG_DATA(recvdCmsg));
+            size_t payloadSize = recvdCmsg->cmsg_len - CMSG_LEN(0);
+            size_t numFds      = payloadSize / sizeof(int);
+
+            for (size_t i = 0; i < numFds; ++i) {
+                message.fds.emplace_back(data[i]);
+            }
+
+            gotFds = true;
+
+            TRACE(Debug::log(TRACE, "parseFromFd: got {} fds on the control wire", numFds));
+        }
 
-        if (recvdCmsg->cmsg_level != SOL_SOCKET || recvdCmsg->cmsg_type != SCM_RIGHTS) {
-            Debug::log(ERR, "protocol error on fd {}: invalid control message on wire of type {}", fd.get(), recvdCmsg->cmsg_type);
+        // the kernel dropped fds that didn't fit
+        if (msg.msg_flags & MSG_CTRUNC) {
+            Debug::log(ERR, "protocol error on fd {}: control message truncated, fds were lost", fd.get());
+            for (const auto& f : message.fds) {
+                close(f);
+            }
             return {.bad = true};
         }
+    } while (sizeWritten == BUFFER_SIZE || (gotFds && sizeWritten > 0));
 
-        int*   data        = rc<int*>(CMSG_DATA(recvdCmsg));
-        size_t payloadSize = recvdCmsg->cmsg_len - CMSG_LEN(0);
-        size_t numFds      = payloadSize / sizeof(int);
+    return message;
+}
+
+ssize_t Hyprwire::sendWithFds(const Hyprutils::OS::CFileDescriptor& fd, std::span<const uint8_t> data, size_t offset, std::span<const int> fds, int flags) {
+    const size_t BATCHES = (fds.size() + HW_MAX_FDS_PER_SENDMSG - 1) / HW_MAX_FDS_PER_SENDMSG;
 
-        message.fds.reserve(message.fds.size() + numFds);
+    if (BATCHES > data.size()) {
+        Debug::log(ERR, "sendWithFds: {} fds need at least {} bytes to go with, message has {}", fds.size(), BATCHES, data.size());
+        errno = EMSGSIZE;
+        return -1;
+    }
 
-        for (size_t i = 0; i < numFds; ++i) {
-            message.fds.emplace_back(data[i]);
+    std::array<uint8_t, CMSG_SPACE(HW_MAX_FDS_PER_SENDMSG * sizeof(int))> controlBuf;
+    size_t                                                               sent = 0;
+
+    while (offset + sent < data.size()) {
+        const size_t AT = offset + sent;
+
+        // NOLINTNEXTLINE
+        msghdr msg = {0}; // NOLINTNEXTLINE
+        iovec  io  = {0};
+
+        // fucking evil!
+        io.iov_base    = cc<void*>(rc<const void*>(data.data() + AT));
+        io.iov_len     = AT + 1 < BATCHES ? 1 : data.size() - AT;
+        msg.msg_iov    = &io;
+        msg.msg_iovlen = 1;
+
+        if (AT < BATCHES) {
+            const auto BATCH = fds.subspan(AT * HW_MAX_FDS_PER_SENDMSG, std::min<size_t>(HW_MAX_FDS_PER_SENDMSG, fds.size() - AT * HW_MAX_FDS_PER_SENDMSG));
+
+            msg.msg_control    = controlBuf.data();
+            msg.msg_controllen = CMSG_SPACE(sizeof(int) * BATCH.size());
+
+            cmsghdr* cmsg    = CMSG_FIRSTHDR(&msg);
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type  = SCM_RIGHTS;
+            cmsg->cmsg_len   = CMSG_LEN(sizeof(int) * BATCH.size());
+
+            std::memcpy(CMSG_DATA(cmsg), BATCH.data(), sizeof(int) * BATCH.size());
         }
 
-        TRACE(Debug::log(TRACE, "parseFromFd: got {} fds on the control wire", numFds));
-    } while (sizeWritten == BUFFER_SIZE);
+        ssize_t ret = 0;
+        do {
+            ret = sendmsg(fd.get(), &msg, flags);
+        } while (ret < 0 && errno == EINTR);
 
-    return message;
+        if (ret < 0)
+            return sent > 0 ? sc<ssize_t>(sent) : -1;
+
+        sent += ret;
+
+        // the socket is full
+        if (sc<size_t>(ret) < io.iov_len)
+            break;
+    }
+
+    return sent;
 }
@@ -1,15 +1,23 @@
 #pragma once
 
+#include <deque>
+#include <span>
 #include <vector>
 #include <cstdint>
+#include <sys/types.h>
 #include <hyprutils/os/FileDescriptor.hpp>
 
 namespace Hyprwire {
     struct SSocketRawParsedMessage {
         std::vector<uint8_t> data;
-        std::vector<int>     fds;
+        std::deque<int>      fds; // messages take theirs from the front
         bool                 bad = false;
     };
 
     SSocketRawParsedMessage parseFromFd(const Hyprutils::OS::CFileDescriptor& fd);
+
+    // sends data from offset on, with fds. A sendmsg takes at most HW_MAX_FDS_PER_SENDMSG fds, so the k-th batch of them goes out
+    // with byte k of data, alone unless it's the last batch. Needs at least a byte per batch. Returns how many bytes went out,
+    // or -1 (errno set) if none did. Less than the rest means the socket is full, call again with the new offset to continue.
+    ssize_t                 sendWithFds(const Hyprutils::OS::CFileDescriptor& fd, std::span<const uint8_t> data, size_t offset, std::span<const int> fds, int flags);
 };
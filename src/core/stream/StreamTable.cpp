@@ -0,0 +1,68 @@
+#include "StreamTable.hpp"
+#include "../../helpers/Log.hpp"
+#include "../../Macros.hpp"
+
+#include <algorithm>
+
+using namespace Hyprwire;
+
+uint32_t CStreamTable::open() {
+    const auto ID = m_nextId++;
+
+    // 0 is never a valid stream
+    if (!m_nextId)
+        m_nextId = 1;
+
+    m_open.emplace_back(ID);
+    return ID;
+}
+
+bool CStreamTable::isOpen(uint32_t stream) {
+    return std::ranges::contains(m_open, stream);
+}
+
+void CStreamTable::close(uint32_t stream) {
+    std::erase(m_open, stream);
+    std::erase_if(m_writable, [stream](const auto& w) { return w.first == stream; });
+}
+
+void CStreamTable::onWritable(uint32_t stream, std::function<void()>&& fn) {
+    m_writable.emplace_back(stream, std::move(fn));
+}
+
+void CStreamTable::drained() {
+    if (m_writable.empty())
+        return;
+
+    // writers may queue more, or wait again
+    auto writable = std::move(m_writable);
+    m_writable.clear();
+
+    for (const auto& [stream, fn] : writable) {
+        if (isOpen(stream))
+            fn();
+    }
+}
+
+void CStreamTable::listen(uint32_t stream, StreamListener&& fn) {
+    m_listeners[stream] = std::move(fn);
+}
+
+void CStreamTable::onData(uint32_t stream, std::span<const uint8_t> chunk) {
+    auto it = m_listeners.find(stream);
+    if (it == m_listeners.end()) {
+        // nobody wanted it, or the listener went away
+        TRACE(Debug::log(TRACE, "stream {}: dropping {} bytes", stream, chunk.size()));
+        return;
+    }
+
+    if (!chunk.empty()) {
+        it->second(chunk, false);
+        return;
+    }
+
+    // the listener might touch the table
+    auto fn = std::move(it->second);
+    m_listeners.erase(it);
+    fn(chunk, true);
+}
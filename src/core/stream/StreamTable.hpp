@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Hyprwire {
+    using StreamListener = std::function<void(std::span<const uint8_t> chunk, bool done)>;
+
+    // streams of one connection. Ids are per direction: the ones we open and the ones the other side opens don't clash.
+    class CStreamTable {
+      public:
+        CStreamTable()  = default;
+        ~CStreamTable() = default;
+
+        // outgoing
+        uint32_t open();
+        bool     isOpen(uint32_t stream);
+        void     close(uint32_t stream);
+
+        // fn runs on the next drained(), once the connection's queue is short enough to write to streams again
+        void     onWritable(uint32_t stream, std::function<void()>&& fn);
+        void     drained();
+
+        // incoming
+        void     listen(uint32_t stream, StreamListener&& fn);
+        void     onData(uint32_t stream, std::span<const uint8_t> chunk);
+
+      private:
+        uint32_t                                                m_nextId = 1;
+        std::vector<uint32_t>                                   m_open;
+        std::unordered_map<uint32_t, StreamListener>            m_listeners;
+        std::vector<std::pair<uint32_t, std::function<void()>>> m_writable;
+    };
+};
@@ -0,0 +1,58 @@
+#include "StringTable.hpp"
+#include "../../helpers/Defines.hpp"
+
+using namespace Hyprwire;
+
+void CStringTable::beginMessage() {
+    m_message++;
+}
+
+std::optional<uint32_t> CStringTable::intern(std::string_view str, bool& define) {
+    define = false;
+
+    if (str.size() < HW_STRING_TABLE_MIN_LEN || str.size() > HW_STRING_TABLE_MAX_LEN)
+        return std::nullopt;
+
+    if (auto it = m_outgoingIds.find(str); it != m_outgoingIds.end()) {
+        m_outgoing.splice(m_outgoing.begin(), m_outgoing, it->second);
+        it->second->lastMessage = m_message;
+        return it->second->id;
+    }
+
+    uint32_t id = m_outgoing.size();
+    if (m_outgoing.size() >= HW_STRING_TABLE_SIZE) {
+        // evict the least recently used one, unless this message still needs it
+        auto& last = m_outgoing.back();
+        if (last.lastMessage == m_message)
+            return std::nullopt;
+
+        id = last.id;
+        m_outgoingIds.erase(last.str);
+        m_outgoing.pop_back();
+    }
+
+    // the map's keys view into the list nodes, which don't move
+    m_outgoing.emplace_front(SOutgoingString{.str = std::string{str}, .id = id, .lastMessage = m_message});
+    m_outgoingIds.emplace(m_outgoing.front().str, m_outgoing.begin());
+
+    define = true;
+    return id;
+}
+
+bool CStringTable::define(uint32_t id, std::string_view str) {
+    if (id >= HW_STRING_TABLE_SIZE || str.size() > HW_STRING_TABLE_MAX_LEN)
+        return false;
+
+    if (m_incoming.size() <= id)
+        m_incoming.resize(id + 1);
+
+    m_incoming.at(id) = std::string{str};
+    return true;
+}
+
+std::optional<std::string_view> CStringTable::lookup(uint32_t id) {
+    if (id >= m_incoming.size() || !m_incoming.at(id))
+        return std::nullopt;
+
+    return *m_incoming.at(id);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Hyprwire {
+    // string ids of one connection, see HW_PROTOCOL_FEATURE_STRING_TABLE. Each side picks the ids of the strings it sends,
+    // the receiving side only mirrors them.
+    class CStringTable {
+      public:
+        CStringTable()  = default;
+        ~CStringTable() = default;
+
+        // outgoing. Starts a message: ids it refers to aren't reused until the next one.
+        void                            beginMessage();
+
+        // the id to send str as. define = the other side doesn't have it yet, send STRING_DEFINE first.
+        // nullopt if it's not worth an id, or every id is taken by this message.
+        std::optional<uint32_t>         intern(std::string_view str, bool& define);
+
+        // incoming
+        bool                            define(uint32_t id, std::string_view str);
+
+        // valid until the id is redefined, which the sender won't do while a message refers to it
+        std::optional<std::string_view> lookup(uint32_t id);
+
+      private:
+        struct SOutgoingString {
+            std::string str;
+            uint32_t    id          = 0;
+            uint64_t    lastMessage = 0;
+        };
+
+        // most recently used first
+        std::list<SOutgoingString>                                                 m_outgoing;
+        std::unordered_map<std::string_view, std::list<SOutgoingString>::iterator> m_outgoingIds;
+        uint64_t                                                                   m_message = 0;
+
+        std::vector<std::optional<std::string>>                                    m_incoming;
+    };
+};
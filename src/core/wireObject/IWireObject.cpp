@@ -3,18 +3,31 @@
 #include "../../Macros.hpp"
 #include "../../helpers/Log.hpp"
 #include "../../helpers/FFI.hpp"
+#include "../../helpers/UTF8.hpp"
+#include "../../helpers/Defines.hpp"
 #include "../client/ClientObject.hpp"
 #include "../message/MessageType.hpp"
 #include "../message/MessageParser.hpp"
 #include "../message/MessageMagic.hpp"
+#include "../message/PackedArray.hpp"
 #include "../message/messages/GenericProtocolMessage.hpp"
+#include "../message/messages/StreamData.hpp"
+#include "../message/messages/StringDefine.hpp"
+#include "../message/messages/FdDefine.hpp"
+#include "../message/messages/FdRelease.hpp"
+#include "../fds/FdCache.hpp"
+#include "../stream/StreamTable.hpp"
+#include "../strings/StringTable.hpp"
 #include <hyprwire/core/types/MessageMagic.hpp>
 #include <hyprutils/utils/ScopeGuard.hpp>
 
+#include <algorithm>
+#include <array>
 #include <cstdarg>
 #include <cstring>
 #include <string_view>
 #include <ffi.h>
+#include <unistd.h>
 
 using namespace Hyprwire;
 using namespace Hyprutils::Utils;
@@ -34,7 +47,6 @@ uint32_t IWireObject::call(uint32_t id, ...) {
     va_start(va, id);
 
     const auto& method = METHODS.at(id);
-    const auto  params = method.params;
 
     if (method.since > m_version) {
         const auto MSG = std::format("method {} since {} but has {}", id, method.since, m_version);
@@ -50,19 +62,40 @@ uint32_t IWireObject::call(uint32_t id, ...) {
         return 0;
     }
 
-    // encode the message
+    if (!interested(id)) {
+        TRACE(Debug::log(TRACE, "call {} on object {}: nobody listens, skipping", id, m_id));
+        return 0;
+    }
+
+    // encode the message. Compact ones get their header once the args' size is known.
+    const bool           COMPACT = compact();
     std::vector<uint8_t> data;
     std::vector<int>     fds;
-    data.emplace_back(HW_MESSAGE_TYPE_GENERIC_PROTOCOL_MESSAGE);
-    data.emplace_back(HW_MESSAGE_MAGIC_TYPE_OBJECT);
 
-    data.resize(data.size() + 4);
-    std::memcpy(&data[data.size() - 4], &m_id, sizeof(m_id));
+    if (!COMPACT) {
+        data.emplace_back(HW_MESSAGE_TYPE_GENERIC_PROTOCOL_MESSAGE);
+        data.emplace_back(HW_MESSAGE_MAGIC_TYPE_OBJECT);
+
+        data.resize(data.size() + 4);
+        std::memcpy(&data[data.size() - 4], &m_id, sizeof(m_id));
+
+        data.emplace_back(HW_MESSAGE_MAGIC_TYPE_UINT);
 
-    data.emplace_back(HW_MESSAGE_MAGIC_TYPE_UINT);
+        data.resize(data.size() + 4);
+        std::memcpy(&data[data.size() - 4], &id, sizeof(id));
+    }
 
-    data.resize(data.size() + 4);
-    std::memcpy(&data[data.size() - 4], &id, sizeof(id));
+    // defined strings and fds have to arrive before the message, and the message after the ones before it. Deferred, coalesced and
+    // high priority calls don't keep their place, so they don't use the tables.
+    const bool    IN_ORDER = (m_id || server()) && method.coalesce == HW_METHOD_COALESCE_NONE && method.priority == HW_METHOD_PRIORITY_NORMAL;
+    CStringTable* strings  = IN_ORDER ? this->strings() : nullptr;
+    CFdCache*     fdCache  = IN_ORDER ? this->fdCache() : nullptr;
+    std::vector<std::pair<uint32_t, std::string_view>> defines;
+    std::vector<std::pair<uint32_t, int>>              fdDefines;
+    if (strings)
+        strings->beginMessage();
+    if (fdCache)
+        fdCache->beginMessage();
 
     size_t returnSeq = 0;
 
@@ -72,76 +105,234 @@ uint32_t IWireObject::call(uint32_t id, ...) {
             TRACE(Debug::log(TRACE, "[{} @ {:.3f}] -- call {}: returnsType has {}", selfClient->m_client->m_fd.get(), steadyMillis(), id, method.returnsType));
         }
 
-        data.emplace_back(HW_MESSAGE_MAGIC_TYPE_SEQ);
-
-        data.resize(data.size() + 4);
         auto     selfClient = reinterpretPointerCast<CClientObject>(m_self.lock());
-        uint32_t seqVal     = ++selfClient->m_client->m_seq;
-        std::memcpy(&data[data.size() - 4], &seqVal, sizeof(seqVal));
-        returnSeq = selfClient->m_client->m_seq;
+        uint32_t seqVal     = selfClient->m_client->nextObjectSeq();
+
+        if (COMPACT)
+            g_messageParser->appendVarInt(data, seqVal);
+        else {
+            data.emplace_back(HW_MESSAGE_MAGIC_TYPE_SEQ);
+            data.resize(data.size() + 4);
+            std::memcpy(&data[data.size() - 4], &seqVal, sizeof(seqVal));
+        }
+
+        returnSeq = seqVal;
+    }
+
+    if (!encodeArgs(method, va, data, fds, alignedArrays(), COMPACT, strings, &defines, fdCache, &fdDefines)) {
+        va_end(va);
+
+        // the table counts strings interned before the failing arg as sent, so the other side has to get them anyway
+        for (const auto& [stringId, str] : defines) {
+            sendMessage(CStringDefineMessage{stringId, str});
+        }
+
+        return 0;
+    }
+
+    va_end(va);
+
+    if (!COMPACT)
+        data.emplace_back(HW_MESSAGE_MAGIC_END);
+
+    auto msg = COMPACT ? CGenericProtocolMessage(m_id, id, data, std::move(fds)) : CGenericProtocolMessage(std::move(data), std::move(fds));
+
+    if (!m_id && !server()) {
+        auto selfClient = reinterpretPointerCast<CClientObject>(m_self.lock());
+
+        TRACE(Debug::log(TRACE, "[{} @ {:.3f}] -- call: waiting on object of type {}", selfClient->m_client->m_fd.get(), steadyMillis(), method.returnsType));
+
+        selfClient->m_client->deferMessage(m_seq, std::move(msg));
+        if (returnSeq) {
+            selfClient->m_client->makeObject(m_protocolName, method.returnsType, returnSeq);
+            return returnSeq;
+        }
+    } else {
+        for (const auto& [stringId, str] : defines) {
+            sendMessage(CStringDefineMessage{stringId, str});
+        }
+
+        for (const auto& [fdId, fd] : fdDefines) {
+            sendMessage(CFdDefineMessage{fdId, fd});
+        }
+
+        sendMessage(msg);
+        if (returnSeq) {
+            // we are a client
+            auto selfClient = reinterpretPointerCast<CClientObject>(m_self.lock());
+            selfClient->m_client->makeObject(m_protocolName, method.returnsType, returnSeq);
+            return returnSeq;
+        }
     }
 
+    return 0;
+}
+
+bool IWireObject::encodeArgs(const SMethod& method, va_list va, std::vector<uint8_t>& data, std::vector<int>& fds, bool alignArrays, bool compact, CStringTable* strings,
+                             std::vector<std::pair<uint32_t, std::string_view>>* defines, CFdCache* fdCache, std::vector<std::pair<uint32_t, int>>* fdDefines) {
+    const auto& params = method.params;
+
+    // v1 args are a magic and the raw value, compact ones only the value
+    const auto PUT_RAW = [&data, compact](eMessageMagic magic, const void* val, size_t size) {
+        if (!compact)
+            data.emplace_back(magic);
+        data.resize(data.size() + size);
+        std::memcpy(&data[data.size() - size], val, size);
+    };
+
     for (size_t i = 0; i < params.size(); ++i) {
         switch (sc<eMessageMagic>(params.at(i))) {
-            case HW_MESSAGE_MAGIC_TYPE_UINT: {
-                data.emplace_back(HW_MESSAGE_MAGIC_TYPE_UINT);
-                data.resize(data.size() + 4);
+            case HW_MESSAGE_MAGIC_TYPE_UINT:
+            case HW_MESSAGE_MAGIC_TYPE_OBJECT:
+            case HW_MESSAGE_MAGIC_TYPE_STREAM: {
                 uint32_t val = va_arg(va, uint32_t);
-                std::memcpy(&data[data.size() - 4], &val, sizeof(val));
+                if (compact)
+                    g_messageParser->appendVarInt(data, val);
+                else
+                    PUT_RAW(sc<eMessageMagic>(params.at(i)), &val, sizeof(val));
                 break;
             }
 
             case HW_MESSAGE_MAGIC_TYPE_INT: {
-                data.emplace_back(HW_MESSAGE_MAGIC_TYPE_INT);
-                data.resize(data.size() + 4);
                 int32_t val = va_arg(va, int32_t);
-                std::memcpy(&data[data.size() - 4], &val, sizeof(val));
+                if (compact)
+                    g_messageParser->appendVarInt(data, zigZag(val));
+                else
+                    PUT_RAW(HW_MESSAGE_MAGIC_TYPE_INT, &val, sizeof(val));
                 break;
             }
 
-            case HW_MESSAGE_MAGIC_TYPE_OBJECT: {
-                data.emplace_back(HW_MESSAGE_MAGIC_TYPE_OBJECT);
-                data.resize(data.size() + 4);
-                uint32_t val = va_arg(va, uint32_t);
-                std::memcpy(&data[data.size() - 4], &val, sizeof(val));
+            case HW_MESSAGE_MAGIC_TYPE_OBJECT_ID: {
+                auto     obj = va_arg(va, IObject*);
+                uint32_t val = 0;
+
+                if (obj) {
+                    auto wire = sc<IWireObject*>(obj);
+                    if (!sameConnection(wire) || !wire->m_id) {
+                        // an id means nothing on another connection, and one we don't have yet can't be sent
+                        Debug::log(ERR, "core protocol error: object arg {} can't be sent on object {}", wire->m_id, m_id);
+                        return false;
+                    }
+
+                    val = wire->m_id;
+                }
+
+                if (compact)
+                    g_messageParser->appendVarInt(data, compactObjectId(val));
+                else
+                    PUT_RAW(HW_MESSAGE_MAGIC_TYPE_OBJECT_ID, &val, sizeof(val));
                 break;
             }
 
             case HW_MESSAGE_MAGIC_TYPE_F32: {
-                data.emplace_back(HW_MESSAGE_MAGIC_TYPE_F32);
-                data.resize(data.size() + 4);
                 float val = va_arg(va, double);
-                std::memcpy(&data[data.size() - 4], &val, sizeof(val));
+                PUT_RAW(HW_MESSAGE_MAGIC_TYPE_F32, &val, sizeof(val));
+                break;
+            }
+
+            case HW_MESSAGE_MAGIC_TYPE_U64: {
+                uint64_t val = va_arg(va, uint64_t);
+                if (compact)
+                    g_messageParser->appendVarInt(data, val);
+                else
+                    PUT_RAW(HW_MESSAGE_MAGIC_TYPE_U64, &val, sizeof(val));
+                break;
+            }
+
+            case HW_MESSAGE_MAGIC_TYPE_I64: {
+                int64_t val = va_arg(va, int64_t);
+                if (compact)
+                    g_messageParser->appendVarInt(data, zigZag(val));
+                else
+                    PUT_RAW(HW_MESSAGE_MAGIC_TYPE_I64, &val, sizeof(val));
+                break;
+            }
+
+            case HW_MESSAGE_MAGIC_TYPE_F64: {
+                double val = va_arg(va, double);
+                PUT_RAW(HW_MESSAGE_MAGIC_TYPE_F64, &val, sizeof(val));
                 break;
             }
 
             case HW_MESSAGE_MAGIC_TYPE_VARCHAR: {
-                data.emplace_back(HW_MESSAGE_MAGIC_TYPE_VARCHAR);
-                auto str = va_arg(va, const char*);
-                data.append_range(g_messageParser->encodeVarInt(std::string_view(str).size()));
-                data.append_range(std::string_view(str));
+                const auto STR = std::string_view(va_arg(va, const char*));
+
+                // compact varchars say in the low bit whether they're a string table id or a length
+                bool       define = false;
+                const auto ID     = strings ? strings->intern(STR, define) : std::nullopt;
+                if (ID) {
+                    if (define)
+                        defines->emplace_back(*ID, STR);
+
+                    if (!compact)
+                        data.emplace_back(HW_MESSAGE_MAGIC_TYPE_VARCHAR_REF);
+                    g_messageParser->appendVarInt(data, compact ? (sc<uint64_t>(*ID) << 1) | 1 : *ID);
+                    break;
+                }
+
+                if (!compact)
+                    data.emplace_back(HW_MESSAGE_MAGIC_TYPE_VARCHAR);
+                g_messageParser->appendVarInt(data, compact ? sc<uint64_t>(STR.size()) << 1 : STR.size());
+                data.append_range(STR);
                 break;
             }
 
             case HW_MESSAGE_MAGIC_TYPE_ARRAY: {
-                const auto arrType = sc<eMessageMagic>(params.at(++i));
-                data.emplace_back(HW_MESSAGE_MAGIC_TYPE_ARRAY);
-                data.emplace_back(arrType);
+                const auto arrType   = sc<eMessageMagic>(params.at(++i));
+                auto       arrayData = va_arg(va, void*);
+                auto       arrayLen  = va_arg(va, uint32_t);
+                const bool ALIGN     = alignArrays && arrayLen >= HW_ALIGNED_ARRAY_MIN_ELEMENTS && isAlignableArrayType(arrType);
+
+                if (!compact) {
+                    data.emplace_back(ALIGN ? HW_MESSAGE_MAGIC_TYPE_ALIGNED_ARRAY : HW_MESSAGE_MAGIC_TYPE_ARRAY);
+                    data.emplace_back(arrType);
+                }
+                g_messageParser->appendVarInt(data, arrayLen);
 
-                auto arrayData = va_arg(va, void*);
-                auto arrayLen  = va_arg(va, uint32_t);
-                data.append_range(g_messageParser->encodeVarInt(arrayLen));
+                if (ALIGN) {
+                    const size_t PAD = (HW_ARRAY_ALIGNMENT - (data.size() + 1) % HW_ARRAY_ALIGNMENT) % HW_ARRAY_ALIGNMENT;
+                    data.emplace_back(PAD);
+                    data.resize(data.size() + PAD);
+                }
 
                 switch (arrType) {
                     case HW_MESSAGE_MAGIC_TYPE_UINT:
                     case HW_MESSAGE_MAGIC_TYPE_INT:
                     case HW_MESSAGE_MAGIC_TYPE_F32:
-                    case HW_MESSAGE_MAGIC_TYPE_OBJECT: {
-                        for (size_t j = 0; j < arrayLen; ++j) {
-                            data.resize(data.size() + 4);
-                            uint32_t val = rc<uint32_t*>(arrayData)[j];
-                            std::memcpy(&data[data.size() - 4], &val, sizeof(val));
+                    case HW_MESSAGE_MAGIC_TYPE_OBJECT:
+                    case HW_MESSAGE_MAGIC_TYPE_U64:
+                    case HW_MESSAGE_MAGIC_TYPE_I64:
+                    case HW_MESSAGE_MAGIC_TYPE_F64: {
+                        const size_t SIZE = primitiveSize(arrType) * arrayLen;
+                        data.resize(data.size() + SIZE);
+                        if (arrayLen)
+                            std::memcpy(&data[data.size() - SIZE], arrayData, SIZE);
+                        break;
+                    }
+                    case HW_MESSAGE_MAGIC_TYPE_PACKED: {
+                        const auto TYPE     = sc<eMessageMagic>(params.at(++i));
+                        const auto ENCODING = sc<eArrayEncoding>(params.at(++i));
+
+                        std::vector<uint8_t> packed;
+                        packArray(packed, TYPE, ENCODING, arrayData, arrayLen);
+
+                        // compact: both sides know the type and encoding from the schema
+                        if (!compact) {
+                            data.emplace_back(TYPE);
+                            data.emplace_back(ENCODING);
                         }
+                        g_messageParser->appendVarInt(data, packed.size());
+                        data.append_range(packed);
+                        break;
+                    }
+                    case HW_MESSAGE_MAGIC_TYPE_STRUCT: {
+                        // compact: both sides know the size from the schema
+                        const size_t SIZE = params.at(++i);
+                        if (!compact)
+                            g_messageParser->appendVarInt(data, SIZE);
+                        data.resize(data.size() + SIZE * arrayLen);
+                        if (arrayLen)
+                            std::memcpy(&data[data.size() - SIZE * arrayLen], arrayData, SIZE * arrayLen);
                         break;
                     }
                     case HW_MESSAGE_MAGIC_TYPE_FD: {
@@ -153,7 +344,7 @@ uint32_t IWireObject::call(uint32_t id, ...) {
                     case HW_MESSAGE_MAGIC_TYPE_VARCHAR: {
                         for (size_t i = 0; i < arrayLen; ++i) {
                             const char* element = rc<const char**>(arrayData)[i];
-                            data.append_range(g_messageParser->encodeVarInt(std::string_view(element).size()));
+                            g_messageParser->appendVarInt(data, std::string_view(element).size());
                             data.append_range(std::string_view(element));
                         }
                         break;
@@ -161,7 +352,7 @@ uint32_t IWireObject::call(uint32_t id, ...) {
                     default: {
                         Debug::log(ERR, "core protocol error: failed marshaling array type");
                         errd();
-                        return 0;
+                        return false;
                     }
                 }
 
@@ -169,43 +360,67 @@ uint32_t IWireObject::call(uint32_t id, ...) {
             }
 
             case HW_MESSAGE_MAGIC_TYPE_FD: {
-                data.emplace_back(HW_MESSAGE_MAGIC_TYPE_FD);
+                if (!compact)
+                    data.emplace_back(HW_MESSAGE_MAGIC_TYPE_FD);
 
                 // add fd to our message
                 fds.emplace_back(va_arg(va, int32_t));
                 break;
             }
 
+            case HW_MESSAGE_MAGIC_TYPE_CACHED_FD: {
+                const auto FD = va_arg(va, int32_t);
+
+                // compact ones are 0 for an fd that comes with the message, or the id + 1
+                bool       define = false;
+                const auto ID     = fdCache ? fdCache->intern(FD, define) : std::nullopt;
+                if (ID) {
+                    if (define)
+                        fdDefines->emplace_back(*ID, FD);
+
+                    if (!compact)
+                        data.emplace_back(HW_MESSAGE_MAGIC_TYPE_CACHED_FD);
+                    g_messageParser->appendVarInt(data, compact ? *ID + 1 : *ID);
+                    break;
+                }
+
+                if (compact)
+                    data.emplace_back(0);
+                else
+                    data.emplace_back(HW_MESSAGE_MAGIC_TYPE_FD);
+                fds.emplace_back(FD);
+                break;
+            }
+
             default: break;
         }
     }
 
-    data.emplace_back(HW_MESSAGE_MAGIC_END);
+    return true;
+}
 
-    auto msg = CGenericProtocolMessage(std::move(data), std::move(fds));
+bool IWireObject::interested(uint32_t id) {
+    return true;
+}
 
-    if (!m_id && !server()) {
-        auto selfClient = reinterpretPointerCast<CClientObject>(m_self.lock());
+bool IWireObject::outgoingFull() {
+    return false;
+}
 
-        TRACE(Debug::log(TRACE, "[{} @ {:.3f}] -- call: waiting on object of type {}", selfClient->m_client->m_fd.get(), steadyMillis(), method.returnsType));
+bool IWireObject::alignedArrays() {
+    return false;
+}
 
-        msg.m_dependsOnSeq = m_seq;
-        selfClient->m_client->m_pendingOutgoing.emplace_back(std::move(msg));
-        if (returnSeq) {
-            selfClient->m_client->makeObject(m_protocolName, method.returnsType, returnSeq);
-            return returnSeq;
-        }
-    } else {
-        sendMessage(msg);
-        if (returnSeq) {
-            // we are a client
-            auto selfClient = reinterpretPointerCast<CClientObject>(m_self.lock());
-            selfClient->m_client->makeObject(m_protocolName, method.returnsType, returnSeq);
-            return returnSeq;
-        }
-    }
+bool IWireObject::compact() {
+    return false;
+}
 
-    return 0;
+CStringTable* IWireObject::strings() {
+    return nullptr;
+}
+
+CFdCache* IWireObject::fdCache() {
+    return nullptr;
 }
 
 void IWireObject::listen(uint32_t id, void* fn) {
@@ -213,9 +428,94 @@ void IWireObject::listen(uint32_t id, void* fn) {
         m_listeners.resize(id + 1);
 
     m_listeners.at(id) = fn;
+
+    if (m_batchDone.size() > id)
+        m_batchDone.at(id) = nullptr;
+}
+
+void IWireObject::listenBatch(uint32_t id, void* fn, void* done) {
+    listen(id, fn);
+
+    if (m_batchDone.size() <= id)
+        m_batchDone.resize(id + 1);
+
+    m_batchDone.at(id) = done;
+}
+
+void IWireObject::setArgViews(bool views) {
+    m_argViews = views;
+}
+
+void IWireObject::setStrictUtf8(bool strict) {
+    m_strictUtf8 = strict;
+}
+
+uint32_t IWireObject::openStream() {
+    // chunks are sent right away, they can't go before a call that's waiting for our id
+    if (!server() && !m_id) {
+        Debug::log(ERR, "openStream: object has no id yet");
+        return 0;
+    }
+
+    auto table = streams();
+    return table ? table->open() : 0;
+}
+
+size_t IWireObject::writeStream(uint32_t stream, std::span<const uint8_t> data) {
+    auto table = streams();
+    if (!table || !table->isOpen(stream)) {
+        Debug::log(ERR, "writeStream: stream {} is not open", stream);
+        return 0;
+    }
+
+    // an empty chunk would end the stream. Stop at a slow reader instead of queueing all of it, the caller resumes from onStreamWritable.
+    size_t written = 0;
+    while (written < data.size() && !outgoingFull()) {
+        const auto CHUNK = data.subspan(written, std::min<size_t>(data.size() - written, HW_STREAM_CHUNK_SIZE));
+        sendMessage(CStreamDataMessage(stream, CHUNK));
+        written += CHUNK.size();
+    }
+
+    return written;
+}
+
+void IWireObject::closeStream(uint32_t stream) {
+    auto table = streams();
+    if (!table || !table->isOpen(stream))
+        return;
+
+    table->close(stream);
+    sendMessage(CStreamDataMessage(stream, {}));
 }
 
-void IWireObject::called(uint32_t id, const std::span<const uint8_t>& data, const std::vector<int>& fds) {
+void IWireObject::releaseFd(int fd) {
+    auto cache = fdCache();
+    if (!cache)
+        return;
+
+    if (const auto ID = cache->release(fd); ID)
+        sendMessage(CFdReleaseMessage{*ID});
+}
+
+void IWireObject::onStreamWritable(uint32_t stream, std::function<void()>&& fn) {
+    auto table = streams();
+    if (!table || !table->isOpen(stream))
+        return;
+
+    if (!outgoingFull()) {
+        fn();
+        return;
+    }
+
+    table->onWritable(stream, std::move(fn));
+}
+
+void IWireObject::listenStream(uint32_t stream, std::function<void(std::span<const uint8_t> chunk, bool done)>&& fn) {
+    if (auto table = streams(); table)
+        table->listen(stream, std::move(fn));
+}
+
+void IWireObject::called(uint32_t id, const std::span<const uint8_t>& data, const std::vector<SWireArgument>& wireArgs, const std::vector<int>& fds, bool compact) {
     const auto METHODS = methodsIn();
     if (METHODS.size() <= id) {
         const auto MSG = std::format("invalid method {} for object {}", id, m_id);
@@ -242,13 +542,35 @@ void IWireObject::called(uint32_t id, const std::span<const uint8_t>& data, cons
         return;
     }
 
-    std::vector<ffi_type*> ffiTypes = {&ffi_type_pointer};
-    size_t                 dataI    = 0;
-    for (size_t i = 0; i < params.size(); ++i) {
+    // batch collectors are plain functions taking the decoded slots, they don't need ffi. They take varchars as views and copy them.
+    const bool BATCH = m_batchDone.size() > id && m_batchDone.at(id);
+    const bool VIEWS = m_argViews || BATCH;
+
+    if (!compact && method.fixedSize && calledFixed(id, method, data, BATCH))
+        return;
+
+    // compact messages carry no types, the params say where each arg is
+    std::vector<SWireArgument> compactArgs;
+    if (compact && !CGenericProtocolMessage::frameCompact(params, data, fds.size(), alignedArrays(), compactArgs)) {
+        const auto MSG = std::format("method {}: args don't match the method", id);
+        Debug::log(ERR, "core protocol error: {}", MSG);
+        error(m_id, MSG);
+        return;
+    }
+
+    const auto& args = compact ? compactArgs : wireArgs;
+
+    // the types were recorded while framing, match them against the method
+    std::vector<bool> cacheableFds(args.size());
+    size_t            argI = 0;
+    for (size_t i = 0; i < params.size(); ++i, ++argI) {
         const auto PARAM      = sc<eMessageMagic>(params.at(i));
-        const auto WIRE_PARAM = sc<eMessageMagic>(data[dataI]);
+        const auto WIRE_PARAM = argI < args.size() ? args.at(argI).type : HW_MESSAGE_MAGIC_END;
 
-        if (PARAM != WIRE_PARAM) {
+        // a cacheable fd may also come as a plain one
+        if (PARAM == HW_MESSAGE_MAGIC_TYPE_CACHED_FD && WIRE_PARAM == HW_MESSAGE_MAGIC_TYPE_FD)
+            cacheableFds.at(argI) = true;
+        else if (PARAM != WIRE_PARAM) {
             // raise protocol error
             const auto MSG = std::format("method {} param idx {} should be {} but was {}", id, i, magicToString(PARAM), magicToString(WIRE_PARAM));
             Debug::log(ERR, "core protocol error: {}", MSG);
@@ -256,25 +578,10 @@ void IWireObject::called(uint32_t id, const std::span<const uint8_t>& data, cons
             return;
         }
 
-        auto ffiType = FFI::ffiTypeFrom(PARAM);
-        ffiTypes.emplace_back(ffiType);
-
         switch (PARAM) {
-            case HW_MESSAGE_MAGIC_END: ++i; break; // BUG if this happens or malformed message
-            case HW_MESSAGE_MAGIC_TYPE_FD: dataI++; break;
-            case HW_MESSAGE_MAGIC_TYPE_UINT:
-            case HW_MESSAGE_MAGIC_TYPE_F32:
-            case HW_MESSAGE_MAGIC_TYPE_INT:
-            case HW_MESSAGE_MAGIC_TYPE_OBJECT:
-            case HW_MESSAGE_MAGIC_TYPE_SEQ: dataI += 5; break;
-            case HW_MESSAGE_MAGIC_TYPE_VARCHAR: {
-                auto [a, b] = g_messageParser->parseVarInt(std::span<const uint8_t>{&data[dataI + 1], data.size() - dataI});
-                dataI += a + b + 1;
-                break;
-            }
             case HW_MESSAGE_MAGIC_TYPE_ARRAY: {
                 const auto arrType  = sc<eMessageMagic>(params.at(++i));
-                const auto wireType = sc<eMessageMagic>(data[dataI + 1]);
+                const auto wireType = args.at(argI).arrType;
 
                 if (arrType != wireType) {
                     // raise protocol error
@@ -284,34 +591,37 @@ void IWireObject::called(uint32_t id, const std::span<const uint8_t>& data, cons
                     return;
                 }
 
-                auto [arrLen, lenLen] = g_messageParser->parseVarInt(std::span<const uint8_t>{&data[dataI + 2], data.size() - i});
-                size_t arrMessageLen  = 2 + lenLen;
-
-                ffiTypes.emplace_back(FFI::ffiTypeFrom(HW_MESSAGE_MAGIC_TYPE_UINT /* length */));
-
                 switch (arrType) {
                     case HW_MESSAGE_MAGIC_TYPE_UINT:
                     case HW_MESSAGE_MAGIC_TYPE_F32:
                     case HW_MESSAGE_MAGIC_TYPE_INT:
                     case HW_MESSAGE_MAGIC_TYPE_OBJECT:
-                    case HW_MESSAGE_MAGIC_TYPE_SEQ: {
-                        arrMessageLen += 4 * arrLen;
-                        break;
-                    }
-                    case HW_MESSAGE_MAGIC_TYPE_VARCHAR: {
-                        for (size_t j = 0; j < arrLen; ++j) {
-                            if (dataI + arrMessageLen > data.size()) {
-                                const auto MSG = std::format("failed demarshaling array message");
-                                Debug::log(ERR, "core protocol error: {}", MSG);
-                                error(m_id, MSG);
-                                return;
-                            }
-                            auto [strLen, strlenLen] = g_messageParser->parseVarInt(std::span<const uint8_t>{&data[dataI + arrMessageLen], data.size() - dataI - arrMessageLen});
-                            arrMessageLen += strLen + strlenLen;
+                    case HW_MESSAGE_MAGIC_TYPE_SEQ:
+                    case HW_MESSAGE_MAGIC_TYPE_U64:
+                    case HW_MESSAGE_MAGIC_TYPE_I64:
+                    case HW_MESSAGE_MAGIC_TYPE_F64:
+                    case HW_MESSAGE_MAGIC_TYPE_VARCHAR:
+                    case HW_MESSAGE_MAGIC_TYPE_FD: break;
+                    case HW_MESSAGE_MAGIC_TYPE_PACKED: {
+                        const auto TYPE     = sc<eMessageMagic>(params.at(++i));
+                        const auto ENCODING = sc<eArrayEncoding>(params.at(++i));
+                        if (args.at(argI).packedType != TYPE || args.at(argI).encoding != ENCODING) {
+                            const auto MSG = std::format("method {} param idx {} should be {} packed as {} but was {} packed as {}", id, i, magicToString(TYPE), sc<int>(ENCODING),
+                                                         magicToString(args.at(argI).packedType), sc<int>(args.at(argI).encoding));
+                            Debug::log(ERR, "core protocol error: {}", MSG);
+                            error(m_id, MSG);
+                            return;
                         }
                         break;
                     }
-                    case HW_MESSAGE_MAGIC_TYPE_FD: {
+                    case HW_MESSAGE_MAGIC_TYPE_STRUCT: {
+                        const uint32_t SIZE = params.at(++i);
+                        if (args.at(argI).elemSize != SIZE) {
+                            const auto MSG = std::format("method {} param idx {} should be structs of {} bytes but were {} bytes", id, i, SIZE, args.at(argI).elemSize);
+                            Debug::log(ERR, "core protocol error: {}", MSG);
+                            error(m_id, MSG);
+                            return;
+                        }
                         break;
                     }
                     default: {
@@ -321,35 +631,29 @@ void IWireObject::called(uint32_t id, const std::span<const uint8_t>& data, cons
                         return;
                     }
                 }
-
-                dataI += arrMessageLen;
                 break;
             }
-            case HW_MESSAGE_MAGIC_TYPE_OBJECT_ID: {
-                const auto MSG = std::format("object type is not impld");
-                Debug::log(ERR, "core protocol error: {}", MSG);
-                error(m_id, MSG);
-                return;
-            }
+            default: break;
         }
     }
 
-    ffi_cif cif;
-    if (ffi_prep_cif(&cif, FFI_DEFAULT_ABI, ffiTypes.size(), &ffi_type_void, ffiTypes.data())) {
+    ffi_cif* cif = BATCH ? nullptr : listenerCif(id, method, VIEWS);
+    if (!BATCH && !cif) {
         Debug::log(ERR, "core protocol error: ffi failed");
         errd();
         return;
     }
 
     std::vector<void*> avalues, otherBuffers;
-    avalues.reserve(ffiTypes.size());
+    std::vector<int>   ownedFds; // plain fds of cacheable args, which listeners don't close
+    avalues.reserve(args.size() * 2 + 1);
     std::vector<SP<std::string>> strings;
 
     auto                         ptrBuf = malloc(sizeof(IObject*));
     avalues.emplace_back(ptrBuf);
     *rc<IObject**>(ptrBuf) = m_self.get();
 
-    size_t      fdNo = 0;
+    size_t      fdNo = 0, objectNo = 0;
 
     CScopeGuard x([&] {
         for (const auto& v : avalues) {
@@ -358,70 +662,161 @@ void IWireObject::called(uint32_t id, const std::span<const uint8_t>& data, cons
         for (const auto& v : otherBuffers) {
             free(v);
         }
+        for (const auto& fd : ownedFds) {
+            close(fd);
+        }
     });
 
-    for (size_t i = 0; i < data.size(); ++i) {
-        void*      buf   = nullptr;
-        const auto PARAM = sc<eMessageMagic>(data[i]);
-        // FIXME: add type checking
-
-        if (PARAM == HW_MESSAGE_MAGIC_END)
-            break;
+    for (size_t i = 0; i < argI; ++i) {
+        void*       buf = nullptr;
+        const auto& ARG = args.at(i);
+        const auto  AT  = data.data() + ARG.offset;
 
-        switch (PARAM) {
-            case HW_MESSAGE_MAGIC_END: break;
-            case HW_MESSAGE_MAGIC_TYPE_UINT: {
+        switch (ARG.type) {
+            case HW_MESSAGE_MAGIC_TYPE_UINT:
+            case HW_MESSAGE_MAGIC_TYPE_OBJECT:
+            case HW_MESSAGE_MAGIC_TYPE_STREAM:
+            case HW_MESSAGE_MAGIC_TYPE_SEQ: {
                 buf = malloc(sizeof(uint32_t));
-                std::memcpy(buf, &data[i + 1], sizeof(uint32_t));
-                i += 4;
+                if (compact)
+                    *rc<uint32_t*>(buf) = ARG.value;
+                else
+                    std::memcpy(buf, AT, sizeof(uint32_t));
                 break;
             }
             case HW_MESSAGE_MAGIC_TYPE_F32: {
                 buf = malloc(sizeof(float));
-                std::memcpy(buf, &data[i + 1], sizeof(float));
-                i += 4;
+                std::memcpy(buf, AT, sizeof(float));
                 break;
             }
             case HW_MESSAGE_MAGIC_TYPE_INT: {
                 buf = malloc(sizeof(int32_t));
-                std::memcpy(buf, &data[i + 1], sizeof(int32_t));
-                i += 4;
+                if (compact)
+                    *rc<int32_t*>(buf) = sc<int64_t>(ARG.value);
+                else
+                    std::memcpy(buf, AT, sizeof(int32_t));
                 break;
             }
-            case HW_MESSAGE_MAGIC_TYPE_OBJECT: {
-                buf = malloc(sizeof(uint32_t));
-                std::memcpy(buf, &data[i + 1], sizeof(uint32_t));
-                i += 4;
+            case HW_MESSAGE_MAGIC_TYPE_U64:
+            case HW_MESSAGE_MAGIC_TYPE_I64:
+            case HW_MESSAGE_MAGIC_TYPE_F64: {
+                buf = malloc(sizeof(uint64_t));
+                if (compact && ARG.type != HW_MESSAGE_MAGIC_TYPE_F64)
+                    *rc<uint64_t*>(buf) = ARG.value;
+                else
+                    std::memcpy(buf, AT, sizeof(uint64_t));
                 break;
             }
-            case HW_MESSAGE_MAGIC_TYPE_SEQ: {
-                buf = malloc(sizeof(uint32_t));
-                std::memcpy(buf, &data[i + 1], sizeof(uint32_t));
-                i += 4;
+            case HW_MESSAGE_MAGIC_TYPE_OBJECT_ID: {
+                uint32_t objId = 0;
+                if (compact)
+                    objId = expandObjectId(ARG.value);
+                else
+                    std::memcpy(&objId, AT, sizeof(objId));
+
+                IWireObject* obj = objId ? connectionObject(objId) : nullptr;
+
+                if (objId && (!obj || !obj->m_spec || objectNo >= method.objectTypes.size() || obj->m_spec->objectName() != method.objectTypes.at(objectNo))) {
+                    const auto MSG = std::format("method {} object arg {}: {} is not a live {}", id, objectNo, objId,
+                                                 objectNo < method.objectTypes.size() ? method.objectTypes.at(objectNo) : "object");
+                    Debug::log(ERR, "core protocol error: {}", MSG);
+                    error(m_id, MSG);
+                    return;
+                }
+
+                objectNo++;
+
+                buf                 = malloc(sizeof(IObject*));
+                *rc<IObject**>(buf) = obj;
                 break;
             }
             case HW_MESSAGE_MAGIC_TYPE_VARCHAR: {
-                auto [strLen, len]     = g_messageParser->parseVarInt(std::span<const uint8_t>{&data[i + 1], data.size() - i - 1});
-                buf                    = malloc(sizeof(const char*));
-                auto& str              = strings.emplace_back(makeShared<std::string>(std::string_view{rc<const char*>(&data[i + len + 1]), strLen}));
-                *rc<const char**>(buf) = str->c_str();
-                i += strLen + len;
+                std::string_view sv{rc<const char*>(AT), ARG.count};
+
+                if (ARG.interned) {
+                    const auto TABLE = this->strings();
+                    const auto STR   = TABLE ? TABLE->lookup(ARG.value) : std::nullopt;
+                    if (!STR) {
+                        const auto MSG = std::format("method {} param idx {}: string id {} was never defined", id, i, ARG.value);
+                        Debug::log(ERR, "core protocol error: {}", MSG);
+                        error(m_id, MSG);
+                        return;
+                    }
+
+                    sv = *STR;
+                }
+
+                if (m_strictUtf8 && !UTF8::valid(sv)) {
+                    const auto MSG = std::format("method {} param idx {}: varchar is not valid UTF-8", id, i);
+                    Debug::log(ERR, "core protocol error: {}", MSG);
+                    error(m_id, MSG);
+                    return;
+                }
+
+                if (VIEWS) {
+                    auto dataSlot = rc<const char**>(malloc(sizeof(const char*)));
+                    auto sizeSlot = rc<uint32_t*>(malloc(sizeof(uint32_t)));
+
+                    *dataSlot = sv.data();
+                    *sizeSlot = sv.size();
+
+                    avalues.emplace_back(dataSlot);
+                    avalues.emplace_back(sizeSlot);
+                    break;
+                }
+
+                buf = malloc(sizeof(const char*));
+
+                // table strings are NUL terminated already, and stay put for the call
+                if (ARG.interned)
+                    *rc<const char**>(buf) = sv.data();
+                else
+                    *rc<const char**>(buf) = strings.emplace_back(makeShared<std::string>(sv))->c_str();
                 break;
             }
             case HW_MESSAGE_MAGIC_TYPE_ARRAY: {
-                const auto arrType    = sc<eMessageMagic>(data[i + 1]);
-                auto [arrLen, lenLen] = g_messageParser->parseVarInt(std::span<const uint8_t>{&data[i + 2], data.size() - i});
-                size_t arrMessageLen  = 2 + lenLen;
+                const auto arrLen = ARG.count;
 
-                switch (arrType) {
+                switch (ARG.arrType) {
                     case HW_MESSAGE_MAGIC_TYPE_UINT:
                     case HW_MESSAGE_MAGIC_TYPE_F32:
                     case HW_MESSAGE_MAGIC_TYPE_INT:
                     case HW_MESSAGE_MAGIC_TYPE_OBJECT:
-                    case HW_MESSAGE_MAGIC_TYPE_SEQ: {
-                        auto dataPtr  = rc<uint32_t*>(malloc(sizeof(uint32_t) * (arrLen == 0 ? 1 : arrLen)));
-                        auto dataSlot = rc<uint32_t**>(malloc(sizeof(uint32_t**)));
-                        auto sizeSlot = rc<uint32_t*>(malloc(sizeof(uint32_t)));
+                    case HW_MESSAGE_MAGIC_TYPE_SEQ:
+                    case HW_MESSAGE_MAGIC_TYPE_U64:
+                    case HW_MESSAGE_MAGIC_TYPE_I64:
+                    case HW_MESSAGE_MAGIC_TYPE_F64: {
+                        const size_t ELEM_SIZE = primitiveSize(ARG.arrType);
+                        auto         dataSlot  = rc<const void**>(malloc(sizeof(void**)));
+                        auto         sizeSlot  = rc<uint32_t*>(malloc(sizeof(uint32_t)));
+
+                        *sizeSlot = arrLen;
+
+                        avalues.emplace_back(dataSlot);
+                        avalues.emplace_back(sizeSlot);
+
+                        // listeners only read the elements during the call, so they can stay in the buffer if they're aligned.
+                        // Aligned arrays are aligned to HW_ARRAY_ALIGNMENT within the message, so whenever the message is within the buffer.
+                        // If it isn't, they stay in place like any other array as long as the elements are aligned.
+                        if (rc<uintptr_t>(AT) % ELEM_SIZE == 0) {
+                            *dataSlot = AT;
+                            break;
+                        }
+
+                        const size_t SIZE    = ELEM_SIZE * (arrLen == 0 ? 1 : arrLen);
+                        auto         dataPtr = aligned_alloc(HW_ARRAY_ALIGNMENT, (SIZE + HW_ARRAY_ALIGNMENT - 1) / HW_ARRAY_ALIGNMENT * HW_ARRAY_ALIGNMENT);
+                        *dataSlot            = dataPtr;
+                        otherBuffers.emplace_back(dataPtr);
+
+                        std::memcpy(dataPtr, AT, ELEM_SIZE * arrLen);
+                        break;
+                    }
+                    case HW_MESSAGE_MAGIC_TYPE_PACKED: {
+                        const size_t ELEM_SIZE = primitiveSize(ARG.packedType);
+                        const size_t SIZE      = ELEM_SIZE * (arrLen == 0 ? 1 : arrLen);
+                        auto         dataPtr   = aligned_alloc(HW_ARRAY_ALIGNMENT, (SIZE + HW_ARRAY_ALIGNMENT - 1) / HW_ARRAY_ALIGNMENT * HW_ARRAY_ALIGNMENT);
+                        auto         dataSlot  = rc<const void**>(malloc(sizeof(void**)));
+                        auto         sizeSlot  = rc<uint32_t*>(malloc(sizeof(uint32_t)));
 
                         *dataSlot = dataPtr;
                         *sizeSlot = arrLen;
@@ -430,17 +825,42 @@ void IWireObject::called(uint32_t id, const std::span<const uint8_t>& data, cons
                         avalues.emplace_back(sizeSlot);
                         otherBuffers.emplace_back(dataPtr);
 
-                        for (size_t j = 0; j < arrLen; ++j) {
-                            std::memcpy(&dataPtr[j], &data[i + arrMessageLen], sizeof(uint32_t));
-                            arrMessageLen += 4;
+                        if (!unpackArray(std::span<const uint8_t>{AT, ARG.size}, ARG.packedType, ARG.encoding, dataPtr, arrLen)) {
+                            const auto MSG = std::format("method {} param idx {}: malformed packed array", id, i);
+                            Debug::log(ERR, "core protocol error: {}", MSG);
+                            error(m_id, MSG);
+                            return;
                         }
                         break;
                     }
-                    case HW_MESSAGE_MAGIC_TYPE_VARCHAR: {
-                        auto dataPtr  = rc<const char**>(malloc(sizeof(const char*) * (arrLen == 0 ? 1 : arrLen)));
-                        auto dataSlot = rc<const char***>(malloc(sizeof(const char***)));
+                    case HW_MESSAGE_MAGIC_TYPE_STRUCT: {
+                        auto dataSlot = rc<const void**>(malloc(sizeof(void**)));
                         auto sizeSlot = rc<uint32_t*>(malloc(sizeof(uint32_t)));
 
+                        *sizeSlot = arrLen;
+
+                        avalues.emplace_back(dataSlot);
+                        avalues.emplace_back(sizeSlot);
+
+                        // the fields are all 4 bytes
+                        if (rc<uintptr_t>(AT) % alignof(uint32_t) == 0) {
+                            *dataSlot = AT;
+                            break;
+                        }
+
+                        auto dataPtr = malloc(ARG.elemSize * (arrLen == 0 ? 1 : arrLen));
+                        *dataSlot    = dataPtr;
+                        otherBuffers.emplace_back(dataPtr);
+
+                        std::memcpy(dataPtr, AT, ARG.elemSize * arrLen);
+                        break;
+                    }
+                    case HW_MESSAGE_MAGIC_TYPE_VARCHAR: {
+                        const size_t ELEM_SIZE = VIEWS ? sizeof(std::string_view) : sizeof(const char*);
+                        auto         dataPtr   = malloc(ELEM_SIZE * (arrLen == 0 ? 1 : arrLen));
+                        auto         dataSlot  = rc<void**>(malloc(sizeof(void**)));
+                        auto         sizeSlot  = rc<uint32_t*>(malloc(sizeof(uint32_t)));
+
                         *dataSlot = dataPtr;
                         *sizeSlot = arrLen;
 
@@ -448,11 +868,25 @@ void IWireObject::called(uint32_t id, const std::span<const uint8_t>& data, cons
                         avalues.emplace_back(sizeSlot);
                         otherBuffers.emplace_back(dataPtr);
 
+                        // element lengths are the one thing framing doesn't keep
+                        size_t off = ARG.offset;
                         for (size_t j = 0; j < arrLen; ++j) {
-                            auto [strLen, strlenLen] = g_messageParser->parseVarInt(std::span<const uint8_t>{&data[i + arrMessageLen], data.size() - i});
-                            auto& str  = strings.emplace_back(makeShared<std::string>(std::string_view{rc<const char*>(&data[i + arrMessageLen + strlenLen]), strLen}));
-                            dataPtr[j] = str->c_str();
-                            arrMessageLen += strlenLen + strLen;
+                            auto [strLen, strlenLen] = g_messageParser->parseVarInt(std::span<const uint8_t>{data.data() + off, data.size() - off});
+                            const auto SV            = std::string_view{rc<const char*>(data.data() + off + strlenLen), strLen};
+
+                            if (m_strictUtf8 && !UTF8::valid(SV)) {
+                                const auto MSG = std::format("method {} param idx {}: varchar {} is not valid UTF-8", id, i, j);
+                                Debug::log(ERR, "core protocol error: {}", MSG);
+                                error(m_id, MSG);
+                                return;
+                            }
+
+                            if (VIEWS)
+                                new (&rc<std::string_view*>(dataPtr)[j]) std::string_view{SV};
+                            else
+                                rc<const char**>(dataPtr)[j] = strings.emplace_back(makeShared<std::string>(SV))->c_str();
+
+                            off += strlenLen + strLen;
                         }
                         break;
                     }
@@ -468,39 +902,148 @@ void IWireObject::called(uint32_t id, const std::span<const uint8_t>& data, cons
                         avalues.emplace_back(sizeSlot);
                         otherBuffers.emplace_back(dataPtr);
 
-                        for (size_t j = 0; j < arrLen; ++j) {
-                            dataPtr[j] = fds.at(fdNo++);
+                        if (fdNo + arrLen > fds.size()) {
+                            Debug::log(ERR, "core protocol error: fd array past the fds of the message");
+                            errd();
+                            return;
                         }
 
+                        std::memcpy(dataPtr, fds.data() + fdNo, sizeof(int32_t) * arrLen);
+                        fdNo += arrLen;
                         break;
                     }
-                    default: {
-                        const auto MSG = std::format("failed demarshaling array message");
-                        Debug::log(ERR, "core protocol error: {}", MSG);
-                        error(m_id, MSG);
-                        return;
-                    }
+                    default: break; // rejected above
                 }
-
-                i += arrMessageLen - 1 /* for loop does ++i*/;
                 break;
             }
-            case HW_MESSAGE_MAGIC_TYPE_OBJECT_ID: {
-                const auto MSG = std::format("object type is not impld");
-                Debug::log(ERR, "core protocol error: {}", MSG);
-                error(m_id, MSG);
-                return;
-            }
             case HW_MESSAGE_MAGIC_TYPE_FD: {
                 buf                = malloc(sizeof(int32_t));
                 *rc<int32_t*>(buf) = fds.at(fdNo++);
+                if (cacheableFds.at(i))
+                    ownedFds.emplace_back(*rc<int32_t*>(buf));
                 break;
             }
+            case HW_MESSAGE_MAGIC_TYPE_CACHED_FD: {
+                // compact messages may have it with the message
+                if (!ARG.interned) {
+                    buf                = malloc(sizeof(int32_t));
+                    *rc<int32_t*>(buf) = fds.at(fdNo++);
+                    ownedFds.emplace_back(*rc<int32_t*>(buf));
+                    break;
+                }
+
+                const auto TABLE = fdCache();
+                const auto FD    = TABLE ? TABLE->lookup(ARG.value) : -1;
+                if (FD < 0) {
+                    const auto MSG = std::format("method {} param idx {}: fd id {} was never defined", id, i, ARG.value);
+                    Debug::log(ERR, "core protocol error: {}", MSG);
+                    error(m_id, MSG);
+                    return;
+                }
+
+                buf                = malloc(sizeof(int32_t));
+                *rc<int32_t*>(buf) = FD;
+                break;
+            }
+            default: break;
         }
         if (buf)
             avalues.emplace_back(buf);
     }
 
+    if (BATCH) {
+        rc<void (*)(IObject*, void**)>(m_listeners.at(id))(m_self.get(), avalues.data() + 1);
+        return;
+    }
+
+    auto fptr = reinterpret_cast<void (*)()>(m_listeners.at(id));
+    ffi_call(cif, fptr, nullptr, avalues.data());
+}
+
+bool IWireObject::calledFixed(uint32_t id, const SMethod& method, const std::span<const uint8_t>& data, bool batch) {
+    constexpr size_t MAX_FIXED_ARGS = 16;
+
+    const size_t     SEQ_ARGS = method.returnsType.empty() ? 0 : 1;
+    const size_t     ARGS     = method.params.size() + SEQ_ARGS;
+
+    // anything off goes the long way, which also reports the error properly
+    if (ARGS > MAX_FIXED_ARGS || data.size() != method.fixedSize || method.fixedSize != ARGS * 5 + 1 || data[ARGS * 5] != HW_MESSAGE_MAGIC_END)
+        return false;
+
+    std::array<void*, MAX_FIXED_ARGS + 1> avalues;
+    std::array<uint32_t, MAX_FIXED_ARGS>  words;
+    IObject*                              self = m_self.get();
+
+    avalues[0] = &self;
+
+    for (size_t i = 0; i < ARGS; ++i) {
+        const auto PARAM = i < SEQ_ARGS ? HW_MESSAGE_MAGIC_TYPE_SEQ : sc<eMessageMagic>(method.params.at(i - SEQ_ARGS));
+
+        if (data[i * 5] != PARAM)
+            return false;
+
+        std::memcpy(&words[i], &data[i * 5 + 1], sizeof(uint32_t));
+        avalues[i + 1] = &words[i];
+    }
+
+    if (batch) {
+        rc<void (*)(IObject*, void**)>(m_listeners.at(id))(self, avalues.data() + 1);
+        return true;
+    }
+
+    // no varchars here, views don't change the types
+    const auto CIF = listenerCif(id, method, m_argViews);
+    if (!CIF) {
+        Debug::log(ERR, "core protocol error: ffi failed");
+        errd();
+        return true;
+    }
+
     auto fptr = reinterpret_cast<void (*)()>(m_listeners.at(id));
-    ffi_call(&cif, fptr, nullptr, avalues.data());
+    ffi_call(CIF, fptr, nullptr, avalues.data());
+    return true;
+}
+
+ffi_cif* IWireObject::listenerCif(uint32_t id, const SMethod& method, bool views) {
+    if (m_cifs.size() <= id)
+        m_cifs.resize(id + 1);
+
+    auto& entry = m_cifs.at(id);
+    if (entry.ready && entry.views == views)
+        return &entry.cif;
+
+    // same layout called() unpacks: self, then each param, with a length after arrays and viewed varchars
+    std::vector<uint8_t> params;
+    if (!method.returnsType.empty())
+        params.emplace_back(HW_MESSAGE_MAGIC_TYPE_SEQ);
+    params.append_range(method.params);
+
+    entry.ready = false;
+    entry.views = views;
+    entry.types = {&ffi_type_pointer};
+
+    for (size_t i = 0; i < params.size(); ++i) {
+        const auto PARAM = sc<eMessageMagic>(params.at(i));
+
+        entry.types.emplace_back(FFI::ffiTypeFrom(PARAM));
+
+        if (PARAM == HW_MESSAGE_MAGIC_TYPE_VARCHAR && views)
+            entry.types.emplace_back(FFI::ffiTypeFrom(HW_MESSAGE_MAGIC_TYPE_UINT /* length */));
+        else if (PARAM == HW_MESSAGE_MAGIC_TYPE_ARRAY) {
+            entry.types.emplace_back(FFI::ffiTypeFrom(HW_MESSAGE_MAGIC_TYPE_UINT /* length */));
+
+            // skip the element type and what describes it
+            const auto ARR_TYPE = sc<eMessageMagic>(params.at(++i));
+            if (ARR_TYPE == HW_MESSAGE_MAGIC_TYPE_PACKED)
+                i += 2;
+            else if (ARR_TYPE == HW_MESSAGE_MAGIC_TYPE_STRUCT)
+                ++i;
+        }
+    }
+
+    if (ffi_prep_cif(&entry.cif, FFI_DEFAULT_ABI, entry.types.size(), &ffi_type_void, entry.types.data()))
+        return nullptr;
+
+    entry.ready = true;
+    return &entry.cif;
 }
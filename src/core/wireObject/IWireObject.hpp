@@ -3,13 +3,21 @@
 #include <hyprwire/core/implementation/Object.hpp>
 #include <hyprwire/core/implementation/Types.hpp>
 #include <span>
+#include <string_view>
+#include <utility>
 #include <vector>
 #include <cstdint>
+#include <cstdarg>
 
 #include "../../helpers/Memory.hpp"
+#include "../../helpers/FFI.hpp"
 
 namespace Hyprwire {
     class IMessage;
+    class CStreamTable;
+    class CStringTable;
+    class CFdCache;
+    struct SWireArgument;
 
     class IWireObject : public IObject {
       public:
@@ -17,15 +25,71 @@ namespace Hyprwire {
 
         virtual uint32_t                    call(uint32_t id, ...);
         virtual void                        listen(uint32_t id, void* fn);
-        virtual void                        called(uint32_t id, const std::span<const uint8_t>& data, const std::vector<int>& fds);
+        virtual void                        listenBatch(uint32_t id, void* fn, void* done);
+        virtual void                        setArgViews(bool views);
+        virtual void                        setStrictUtf8(bool strict);
+        virtual uint32_t                    openStream();
+        virtual size_t                      writeStream(uint32_t stream, std::span<const uint8_t> data);
+        virtual void                        closeStream(uint32_t stream);
+        virtual void                        listenStream(uint32_t stream, std::function<void(std::span<const uint8_t> chunk, bool done)>&& fn);
+        virtual void                        releaseFd(int fd);
+        virtual void                        onStreamWritable(uint32_t stream, std::function<void()>&& fn);
+        virtual void                        called(uint32_t id, const std::span<const uint8_t>& data, const std::vector<SWireArgument>& args, const std::vector<int>& fds,
+                                                   bool compact);
+        bool                                calledFixed(uint32_t id, const SMethod& method, const std::span<const uint8_t>& data, bool batch);
         virtual const std::vector<SMethod>& methodsOut()                 = 0;
         virtual const std::vector<SMethod>& methodsIn()                  = 0;
         virtual void                        errd()                       = 0;
         virtual void                        sendMessage(const IMessage&) = 0;
         virtual bool                        server()                     = 0;
 
+        // streams of our connection, nullptr if it's gone
+        virtual CStreamTable*               streams() = 0;
+
+        // strings of our connection, nullptr if STRING_TABLE wasn't granted
+        virtual CStringTable*               strings();
+
+        // fds of our connection, nullptr if FD_CACHE wasn't granted
+        virtual CFdCache*                   fdCache();
+
+        // objects of our connection, for OBJECT_ID args
+        virtual IWireObject*                connectionObject(uint32_t id)      = 0;
+        virtual bool                        sameConnection(IWireObject* other) = 0;
+
+        // whether the other side listens to method id. Not interested = don't bother sending it.
+        virtual bool                        interested(uint32_t id);
+
+        // whether the other side takes ALIGNED_ARRAY
+        virtual bool                        alignedArrays();
+
+        // whether calls go out as COMPACT_PROTOCOL_MESSAGE
+        virtual bool                        compact();
+
+        // whether the other side is too far behind to take stream data, see HW_STREAM_MAX_QUEUED_BYTES
+        virtual bool                        outgoingFull();
+
+        // encodes the method's params from va into data (and fds), without the header and END. data must start at the message start,
+        // or for compact ones, at the start of the args. With strings, varchars may go as ids, and the ones to STRING_DEFINE first
+        // are added to defines. Same for cacheable fds with fdCache, and fdDefines.
+        bool                                encodeArgs(const SMethod& method, va_list va, std::vector<uint8_t>& data, std::vector<int>& fds, bool alignArrays, bool compact,
+                                                       CStringTable* strings, std::vector<std::pair<uint32_t, std::string_view>>* defines, CFdCache* fdCache,
+                                                       std::vector<std::pair<uint32_t, int>>* fdDefines);
+
+        // a listener's call interface, prepped on its first call. The cif points into types, which moves along with it.
+        struct SListenerCif {
+            ffi_cif                cif   = {};
+            std::vector<ffi_type*> types;
+            bool                   ready = false, views = false;
+        };
+
+        // the cif for calling listener id with views or not, nullptr if ffi can't do it
+        ffi_cif*                            listenerCif(uint32_t id, const SMethod& method, bool views);
+
         std::vector<void*>                  m_listeners;
+        std::vector<SListenerCif>           m_cifs; // per method
+        std::vector<void*>                  m_batchDone; // per method, set if the listener is a batch collector
         uint32_t                            m_id = 0, m_version = 0, m_seq = 1;
+        bool                                m_argViews = false, m_strictUtf8 = false;
         std::string                         m_protocolName;
 
         SP<IProtocolObjectSpec>             m_spec;
@@ -3,5 +3,88 @@
 #include <cstdint>
 
 namespace Hyprwire {
-    constexpr const uint32_t HYPRWIRE_PROTOCOL_VER = 1;
+    constexpr const uint32_t HYPRWIRE_PROTOCOL_VER     = 3;
+    constexpr const uint32_t HYPRWIRE_PROTOCOL_VER_MIN = 1;
+
+    // first version that sends generic messages as COMPACT_PROTOCOL_MESSAGE
+    constexpr const uint32_t HW_PROTOCOL_VER_COMPACT = 3;
+
+    /*
+        Optional wire features, negotiated during the handshake (protocol version 2+).
+        The client requests a mask in HANDSHAKE_ACK, the server grants a subset of it in HANDSHAKE_PROTOCOLS.
+    */
+    enum eProtocolFeature : uint32_t {
+        /*
+            Object ids are allocated by the client from the client id range. The seq sent in BIND_PROTOCOL / returns methods
+            is the new object's id, and the server does not send NEW_OBJECT.
+        */
+        HW_PROTOCOL_FEATURE_CLIENT_IDS = (1 << 0),
+
+        /*
+            The client sends the names of the protocols it wants in HANDSHAKE_ACK. The server answers with their versions
+            instead of the full protocol list, and BIND_PROTOCOL may reference a protocol by its index in the query.
+        */
+        HW_PROTOCOL_FEATURE_PROTOCOL_QUERY = (1 << 1),
+
+        /*
+            The client reports which events it listens to per object with EVENT_INTEREST, and the server
+            doesn't send the others.
+        */
+        HW_PROTOCOL_FEATURE_EVENT_INTEREST = (1 << 2),
+
+        /*
+            Both sides accept ALIGNED_ARRAY wherever an ARRAY of UINT, INT, F32, U64, I64 or F64 is expected.
+        */
+        HW_PROTOCOL_FEATURE_ALIGNED_ARRAYS = (1 << 3),
+
+        /*
+            Everything after HANDSHAKE_PROTOCOLS is sent in a FRAME, which says how long the message is and how many fds it has.
+        */
+        HW_PROTOCOL_FEATURE_FRAMES = (1 << 4),
+
+        /*
+            Either side may define ids for strings it sends with STRING_DEFINE, and send varchar args as VARCHAR_REF to them.
+        */
+        HW_PROTOCOL_FEATURE_STRING_TABLE = (1 << 5),
+
+        /*
+            Either side may keep fds it sent open on the other side with FD_DEFINE, and send cacheable fd args as CACHED_FD ids of them.
+        */
+        HW_PROTOCOL_FEATURE_FD_CACHE = (1 << 6),
+    };
+
+    constexpr const uint32_t HYPRWIRE_PROTOCOL_FEATURES = HW_PROTOCOL_FEATURE_CLIENT_IDS | HW_PROTOCOL_FEATURE_PROTOCOL_QUERY | HW_PROTOCOL_FEATURE_EVENT_INTEREST |
+        HW_PROTOCOL_FEATURE_ALIGNED_ARRAYS | HW_PROTOCOL_FEATURE_FRAMES | HW_PROTOCOL_FEATURE_STRING_TABLE | HW_PROTOCOL_FEATURE_FD_CACHE;
+
+    // ALIGNED_ARRAY data alignment, relative to the message start. Also what the receiver copies misplaced data to.
+    constexpr const uint32_t HW_ARRAY_ALIGNMENT = 16;
+
+    // smaller arrays aren't worth the padding
+    constexpr const uint32_t HW_ALIGNED_ARRAY_MIN_ELEMENTS = 16;
+
+    // STREAM_DATA payload limit. Keeps a chunk within one read, so the receiver gets it without buffering more.
+    constexpr const uint32_t HW_STREAM_CHUNK_SIZE = 4096;
+
+    // SCM_MAX_FD, the most fds the kernel takes with one sendmsg. More are spread over several, see sendWithFds.
+    constexpr const uint32_t HW_MAX_FDS_PER_SENDMSG = 253;
+
+    // larger FRAMEs are a protocol error, a partial one is kept around until the rest arrives
+    constexpr const uint32_t HW_MAX_FRAME_SIZE = 16 * 1024 * 1024;
+
+    // a server client with more than this queued isn't keeping up and gets disconnected. Coalesced events don't add to it.
+    constexpr const size_t HW_MAX_OUTGOING_BYTES = 64 * 1024 * 1024;
+
+    // writeStream takes no more data while a server client has this much queued, so streams don't grow the queue towards the limit above
+    constexpr const size_t HW_STREAM_MAX_QUEUED_BYTES = 1024 * 1024;
+
+    // string table ids are [0, HW_STRING_TABLE_SIZE) per direction. Shorter strings aren't worth an id, longer ones aren't kept.
+    constexpr const uint32_t HW_STRING_TABLE_SIZE    = 256;
+    constexpr const uint32_t HW_STRING_TABLE_MIN_LEN = 4;
+    constexpr const uint32_t HW_STRING_TABLE_MAX_LEN = 1024;
+
+    // fd cache ids are [0, HW_FD_CACHE_SIZE) per direction, which is also how many fds the receiver keeps open for them
+    constexpr const uint32_t HW_FD_CACHE_SIZE = 64;
+
+    // client-allocated ids live in [HW_CLIENT_ID_BASE, UINT32_MAX], server-allocated ones below it.
+    constexpr const uint32_t HW_CLIENT_ID_BASE = 0x80000000;
 }
@@ -1,5 +1,8 @@
 #include "Env.hpp"
+#include "Defines.hpp"
+#include "Memory.hpp"
 
+#include <algorithm>
 #include <cstdlib>
 #include <string_view>
 
@@ -16,7 +19,27 @@ bool Hyprwire::Env::envEnabled(const std::string& env) {
     return !sv.empty() && sv != "0";
 }
 
+uint32_t Hyprwire::Env::envUint(const std::string& env, uint32_t fallback) {
+    auto ret = getenv(env.c_str());
+    if (!ret || !*ret)
+        return fallback;
+
+    char*      end = nullptr;
+    const auto VAL = strtoul(ret, &end, 0);
+
+    return *end || VAL > UINT32_MAX ? fallback : sc<uint32_t>(VAL);
+}
+
 bool Hyprwire::Env::isTrace() {
     static bool TRACE = envEnabled("HW_TRACE");
     return TRACE;
-}
\ No newline at end of file
+}
+uint32_t Hyprwire::Env::clientFeatures() {
+    static uint32_t FEATURES = HYPRWIRE_PROTOCOL_FEATURES & envUint("HW_CLIENT_FEATURES", HYPRWIRE_PROTOCOL_FEATURES);
+    return FEATURES;
+}
+
+uint32_t Hyprwire::Env::clientMaxVersion() {
+    static uint32_t VERSION = std::clamp(envUint("HW_CLIENT_MAX_VERSION", HYPRWIRE_PROTOCOL_VER), HYPRWIRE_PROTOCOL_VER_MIN, HYPRWIRE_PROTOCOL_VER);
+    return VERSION;
+}
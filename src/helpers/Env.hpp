@@ -1,8 +1,16 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 
 namespace Hyprwire::Env {
-    bool envEnabled(const std::string& env);
-    bool isTrace();
+    bool     envEnabled(const std::string& env);
+    uint32_t envUint(const std::string& env, uint32_t fallback);
+    bool     isTrace();
+
+    // the features a client asks for, HW_CLIENT_FEATURES masks them. Mostly for testing the fallbacks.
+    uint32_t clientFeatures();
+
+    // the highest protocol version a client offers, HW_CLIENT_MAX_VERSION lowers it. For testing older versions.
+    uint32_t clientMaxVersion();
 }
@@ -6,11 +6,17 @@ ffi_type* Hyprwire::FFI::ffiTypeFrom(eMessageMagic magic) {
     switch (magic) {
         case HW_MESSAGE_MAGIC_TYPE_UINT:
         case HW_MESSAGE_MAGIC_TYPE_OBJECT:
+        case HW_MESSAGE_MAGIC_TYPE_STREAM:
         case HW_MESSAGE_MAGIC_TYPE_SEQ: return &ffi_type_uint32;
         case HW_MESSAGE_MAGIC_TYPE_FD:
+        case HW_MESSAGE_MAGIC_TYPE_CACHED_FD:
         case HW_MESSAGE_MAGIC_TYPE_INT: return &ffi_type_sint32;
         case HW_MESSAGE_MAGIC_TYPE_F32: return &ffi_type_float;
+        case HW_MESSAGE_MAGIC_TYPE_U64: return &ffi_type_uint64;
+        case HW_MESSAGE_MAGIC_TYPE_I64: return &ffi_type_sint64;
+        case HW_MESSAGE_MAGIC_TYPE_F64: return &ffi_type_double;
         case HW_MESSAGE_MAGIC_TYPE_VARCHAR:
+        case HW_MESSAGE_MAGIC_TYPE_OBJECT_ID:
         case HW_MESSAGE_MAGIC_TYPE_ARRAY: return &ffi_type_pointer;
         default: return nullptr;
     }
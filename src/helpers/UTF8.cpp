@@ -0,0 +1,115 @@
+#include "UTF8.hpp"
+#include "Memory.hpp"
+
+#include <cstdint>
+
+// SSE2 is the fallback path, so 32 bit x86 only gets the vector paths when it is built with it
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+#include <immintrin.h>
+#define HW_UTF8_X86
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define HW_UTF8_NEON
+#endif
+
+using namespace Hyprwire;
+
+// Strings on the wire are mostly ASCII, so the vector paths only skip ASCII runs, and the scalar decoder below
+// takes over from the first byte with the high bit set until it's back on ASCII.
+
+#ifdef HW_UTF8_X86
+__attribute__((target("avx2"))) static size_t asciiPrefixAVX2(const uint8_t* data, size_t len) {
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        if (_mm256_movemask_epi8(_mm256_loadu_si256(rc<const __m256i*>(data + i))))
+            break;
+    }
+    return i;
+}
+
+static size_t asciiPrefixSSE2(const uint8_t* data, size_t len) {
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        if (_mm_movemask_epi8(_mm_loadu_si128(rc<const __m128i*>(data + i))))
+            break;
+    }
+    return i;
+}
+
+static size_t asciiPrefix(const uint8_t* data, size_t len) {
+    static const bool AVX2 = __builtin_cpu_supports("avx2");
+    return AVX2 ? asciiPrefixAVX2(data, len) : asciiPrefixSSE2(data, len);
+}
+#elif defined(HW_UTF8_NEON)
+static size_t asciiPrefix(const uint8_t* data, size_t len) {
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        if (vmaxvq_u8(vld1q_u8(data + i)) & 0x80)
+            break;
+    }
+    return i;
+}
+#else
+static size_t asciiPrefix(const uint8_t* data, size_t len) {
+    return 0;
+}
+#endif
+
+// length of the valid sequence starting at data[0] (a non-ASCII lead byte), 0 if it's malformed
+static size_t sequenceLength(const uint8_t* data, size_t len) {
+    const uint8_t LEAD = data[0];
+
+    size_t        seqLen = 0;
+    uint8_t       lo = 0x80, hi = 0xBF; // range of the second byte
+    if (LEAD >= 0xC2 && LEAD <= 0xDF)
+        seqLen = 2;
+    else if (LEAD >= 0xE0 && LEAD <= 0xEF) {
+        seqLen = 3;
+        if (LEAD == 0xE0)
+            lo = 0xA0; // overlong
+        else if (LEAD == 0xED)
+            hi = 0x9F; // surrogates
+    } else if (LEAD >= 0xF0 && LEAD <= 0xF4) {
+        seqLen = 4;
+        if (LEAD == 0xF0)
+            lo = 0x90; // overlong
+        else if (LEAD == 0xF4)
+            hi = 0x8F; // past U+10FFFF
+    } else
+        return 0;
+
+    if (len < seqLen || data[1] < lo || data[1] > hi)
+        return 0;
+
+    for (size_t i = 2; i < seqLen; ++i) {
+        if ((data[i] & 0xC0) != 0x80)
+            return 0;
+    }
+
+    return seqLen;
+}
+
+bool Hyprwire::UTF8::valid(std::string_view str) {
+    const auto   DATA = rc<const uint8_t*>(str.data());
+    const size_t LEN  = str.size();
+
+    size_t       i = 0;
+    while (i < LEN) {
+        i += asciiPrefix(DATA + i, LEN - i);
+
+        // the tail shorter than a vector, or the block with the non-ASCII byte
+        while (i < LEN && DATA[i] < 0x80) {
+            i++;
+        }
+
+        // non-ASCII text tends to stay non-ASCII, decode the whole run before going back to the vector path
+        while (i < LEN && DATA[i] >= 0x80) {
+            const size_t SEQ_LEN = sequenceLength(DATA + i, LEN - i);
+            if (!SEQ_LEN)
+                return false;
+            i += SEQ_LEN;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <string_view>
+
+namespace Hyprwire::UTF8 {
+    // whether str is well-formed UTF-8: no overlong forms, surrogates or code points past U+10FFFF
+    bool valid(std::string_view str);
+}
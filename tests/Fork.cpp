@@ -1,5 +1,6 @@
 #include <hyprwire/hyprwire.hpp>
 #include <print>
+#include <sys/mman.h>
 #include <sys/poll.h>
 #include <sys/signal.h>
 #include <sys/socket.h>
@@ -32,6 +33,10 @@ static void                               makeObject(uint32_t seq) {
 
     object->setMakeObject(makeObject);
     object->setSendMessage([](const char* msg) { std::println("Object says hello: {}", msg); });
+    object->setSetSibling([wobj = WP<CMyObjectV1Object>{object}](CMyObjectV1Object* sibling) {
+        const auto INDEX = [](CMyObjectV1Object* o) { return std::ranges::find_if(objects, [o](const auto& other) { return other.get() == o; }) - objects.begin(); };
+        std::println("Object {} linked to object {}", INDEX(wobj.get()), sibling ? std::to_string(INDEX(sibling)) : "null");
+    });
     object->setSendEnum([wobj = WP<CMyObjectV1Object>{object}](testProtocolV1MyEnum e) {
         std::println("Object sent enum: {}", sc<uint32_t>(e));
 
@@ -43,6 +48,9 @@ static void                               makeObject(uint32_t seq) {
     });
 
     objects.emplace_back(std::move(object));
+
+    if (objects.size() == 2)
+        CMyObjectV1Object::broadcastSendMessage(objects, "Hello all objects");
 }
 
 static SP<CTestProtocolV1Impl> spec = makeShared<CTestProtocolV1Impl>(TEST_PROTOCOL_VERSION, [](SP<Hyprwire::IObject> obj) {
@@ -76,6 +84,39 @@ static SP<CTestProtocolV1Impl> spec = makeShared<CTestProtocolV1Impl>(TEST_PROTO
         conct.pop_back();
         std::println("Got uint array message: \"{}\"", conct);
     });
+    manager->setSendPointBatch([](std::span<const std::tuple<int32_t, int32_t>> calls) {
+        std::println("Got {} points at once", calls.size());
+        for (const auto& [x, y] : calls) {
+            manager->sendPoint(x * 2, y * 2);
+        }
+    });
+    manager->setSendWindows([](const std::vector<STestProtocolV1Window>& windows) {
+        for (const auto& w : windows) {
+            std::println("Got window {}: {}x{} at {}, {}", w.id, w.w, w.h, w.x, w.y);
+        }
+    });
+    manager->setSendStats([](uint64_t timestamp, int64_t delta, double load, const std::vector<uint64_t>& frameTimes) {
+        std::println("Got stats: timestamp {}, delta {}, load {}, {} frame times, last {}", timestamp, delta, load, frameTimes.size(), frameTimes.back());
+    });
+    manager->setSendBlob([](const char* mime, uint32_t stream) {
+        manager->getObject()->listenStream(stream, [mime = std::string{mime}, chunks = 0UL, size = 0UL](std::span<const uint8_t> chunk, bool done) mutable {
+            if (!done) {
+                chunks++;
+                size += chunk.size();
+                return;
+            }
+
+            std::println("Got {} blob of {} bytes in {} chunks", mime, size, chunks);
+        });
+    });
+    manager->setSendIds([](const std::vector<uint32_t>& ids, const std::vector<int32_t>& mask) {
+        std::println("Got {} ids, last {}, mask of {}", ids.size(), ids.back(), mask.size());
+    });
+    manager->setSendBuffer([](uint32_t frame, int fd) {
+        char buf[7] = {0};
+        sc<void>(pread(fd, buf, 6, 0));
+        std::println("Got buffer for frame {}: {}", frame, buf);
+    });
     manager->setMakeObject(makeObject);
     manager->setOnDestroy([w = WP<CMyManagerV1Object>{manager}]() { //
         std::println("object {:x} destroyed", (uintptr_t)manager.get());
@@ -124,16 +165,21 @@ static void                    server(int clientFd) {
     }
 }
 
-static void client(int serverFd) {
-    auto sock = Hyprwire::IClientSocket::open(serverFd);
+static void client(int serverFd, bool optimistic) {
+    auto sock = optimistic ? Hyprwire::IClientSocket::open(serverFd, true) : Hyprwire::IClientSocket::open(serverFd);
+
+    sock->addImplementation(impl);
+
+    // optimistic: bind goes out together with the handshake
+    SP<CCMyManagerV1Object> cmanager;
+    if (optimistic)
+        cmanager = makeShared<CCMyManagerV1Object>(sock->bindProtocol(impl->protocol(), TEST_PROTOCOL_VERSION));
 
     if (!sock->waitForHandshake()) {
         std::println("err: handshake failed");
         return;
     }
 
-    sock->addImplementation(impl);
-
     std::println("OK!");
 
     const auto SPEC = sock->getSpec(impl->protocol()->specName());
@@ -143,11 +189,10 @@ static void client(int serverFd) {
         return;
     }
 
-    std::println("test protocol supported at version {}. Binding.", SPEC->specVer());
-
-    auto cmanager = makeShared<CCMyManagerV1Object>(sock->bindProtocol(impl->protocol(), TEST_PROTOCOL_VERSION));
+    if (!cmanager)
+        cmanager = makeShared<CCMyManagerV1Object>(sock->bindProtocol(impl->protocol(), TEST_PROTOCOL_VERSION));
 
-    std::println("Bound!");
+    std::println("test protocol supported at version {}. Bound!", SPEC->specVer());
 
     int pips[2];
     sc<void>(pipe(pips));
@@ -160,7 +205,35 @@ static void client(int serverFd) {
     cmanager->sendSendMessageArray(std::vector<const char*>{"Hello", "via", "array!"});
     cmanager->sendSendMessageArray(std::vector<const char*>{});
     cmanager->sendSendMessageArrayUint(std::vector<uint32_t>{69, 420, 2137});
+    cmanager->sendSendMessageArrayUint(std::vector<uint32_t>{1, 2, 3});
+    cmanager->sendSendStats(1ULL << 40, -(1LL << 35), 0.125, std::vector<uint64_t>{1ULL << 33, 17, 1ULL << 63});
+    std::vector<uint8_t> blob(10000, 'x');
+    const auto           STREAM = cmanager->getObject()->openStream();
+    cmanager->sendSendBlob("text/plain", STREAM);
+    cmanager->getObject()->writeStream(STREAM, blob);
+    cmanager->getObject()->closeStream(STREAM);
+    std::vector<uint32_t> ids;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        ids.emplace_back(100000 + i * 3);
+    }
+    cmanager->sendSendIds(ids, std::vector<int32_t>(500, -1));
+    const int BUFFER = memfd_create("buffer", MFD_CLOEXEC);
+    sc<void>(write(BUFFER, "pixels", 6));
+    for (uint32_t frame = 0; frame < 3; ++frame) {
+        cmanager->sendSendBuffer(frame, BUFFER);
+    }
+    cmanager->getObject()->releaseFd(BUFFER);
+    close(BUFFER);
+    cmanager->sendSendWindows(std::vector<STestProtocolV1Window>{{.id = 1, .x = -10, .y = 20, .w = 640, .h = 480}, {.id = 2, .x = 0, .y = 0, .w = 1920, .h = 1080}});
     cmanager->setSendMessage([](const char* msg) { std::println("Server says {}", msg); });
+    cmanager->setPointBatch([](std::span<const std::tuple<int32_t, int32_t>> points) {
+        for (const auto& [x, y] : points) {
+            std::println("Server sent point {}, {}", x, y);
+        }
+    });
+    for (int32_t i = 1; i <= 3; ++i) {
+        cmanager->sendSendPoint(i, -i);
+    }
 
     auto cobject  = makeShared<CCMyObjectV1Object>(cmanager->sendMakeObject());
     auto cobject2 = makeShared<CCMyObjectV1Object>(cobject->sendMakeObject());
@@ -173,8 +246,11 @@ static void client(int serverFd) {
         quitt = true;
     });
 
+    cobject2->sendSetSibling(cobject.get());
     cobject->sendSendMessage("Hello from object");
+    sock->roundtripAsync([] { std::println("Roundtrip 1 done"); });
     cobject2->sendSendMessage("Hello from object2");
+    sock->roundtripAsync([] { std::println("Roundtrip 2 done"); });
 
     while (!quitt)
         sock->dispatchEvents(true);
@@ -197,7 +273,7 @@ int main(int argc, char** argv, char** envp) {
     } else if (chld == 0) {
         // CHILD (Client)
         close(sockFds[s]);
-        client(sockFds[c]);
+        client(sockFds[c], argc > 1 && std::string_view{argv[1]} == "--optimistic");
     } else {
         // PARENT (Server)
         close(sockFds[c]);
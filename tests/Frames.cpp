@@ -0,0 +1,193 @@
+#include <hyprwire/hyprwire.hpp>
+#include <hyprwire/core/types/MessageMagic.hpp>
+#include <cstring>
+#include <print>
+#include <sys/poll.h>
+#include <sys/signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "generated/test_protocol_v1-server.hpp"
+#include "generated/test_protocol_v1-client.hpp"
+
+using namespace Hyprutils::Memory;
+using namespace Hyprwire;
+
+#define SP CSharedPointer
+
+constexpr const uint32_t TEST_PROTOCOL_VERSION = 1;
+
+// FRAME and GENERIC_PROTOCOL_MESSAGE on the wire, and the manager's id: the first object of a client without client ids
+constexpr const uint8_t  FRAME                    = 17;
+constexpr const uint8_t  GENERIC_PROTOCOL_MESSAGE = 100;
+constexpr const uint32_t MANAGER_ID               = 1;
+constexpr const uint64_t MAX_FRAME_SIZE           = 16 * 1024 * 1024;
+
+// my_manager_v1 c2s methods
+constexpr const uint32_t SEND_MESSAGE = 0;
+
+// frames sent as chunks, the server reads each one before the next is written
+struct SCase {
+    const char*                       name;
+    std::vector<std::vector<uint8_t>> chunks;
+    size_t                            messages = 0; // accepted by the server, 0 if it has to drop us
+};
+
+static std::vector<uint8_t> varInt(uint64_t value) {
+    std::vector<uint8_t> data;
+    do {
+        data.emplace_back((value & 0x7F) | (value > 0x7F ? 0x80 : 0));
+        value >>= 7;
+    } while (value);
+    return data;
+}
+
+static std::vector<uint8_t> cat(std::initializer_list<std::vector<uint8_t>> parts) {
+    std::vector<uint8_t> data;
+    for (const auto& p : parts) {
+        data.append_range(p);
+    }
+    return data;
+}
+
+static std::vector<uint8_t> sendMessage(const std::string& str) {
+    std::vector<uint8_t> data = {GENERIC_PROTOCOL_MESSAGE, HW_MESSAGE_MAGIC_TYPE_OBJECT, 0, 0, 0, 0, HW_MESSAGE_MAGIC_TYPE_UINT, 0, 0, 0, 0};
+    std::memcpy(&data[2], &MANAGER_ID, sizeof(MANAGER_ID));
+    std::memcpy(&data[7], &SEND_MESSAGE, sizeof(SEND_MESSAGE));
+    data.emplace_back(HW_MESSAGE_MAGIC_TYPE_VARCHAR);
+    data.append_range(varInt(str.size()));
+    data.append_range(str);
+    data.emplace_back(HW_MESSAGE_MAGIC_END);
+    return data;
+}
+
+static std::vector<uint8_t> frame(const std::vector<uint8_t>& message) {
+    return cat({{FRAME}, varInt(message.size()), varInt(0), message});
+}
+
+// splits data into chunks of at most size bytes
+static std::vector<std::vector<uint8_t>> split(const std::vector<uint8_t>& data, size_t size) {
+    std::vector<std::vector<uint8_t>> chunks;
+    for (size_t i = 0; i < data.size(); i += size) {
+        chunks.emplace_back(data.begin() + i, data.begin() + std::min(i + size, data.size()));
+    }
+    return chunks;
+}
+
+static const std::string        LONG_MESSAGE(300000, 'x');
+
+static const std::vector<SCase> CASES = {
+    {.name = "frame in one read", .chunks = {frame(sendMessage("hi"))}, .messages = 1},
+    {.name = "frame a byte per read", .chunks = split(frame(sendMessage("hi")), 1), .messages = 1},
+    {.name = "two frames across reads", .chunks = split(cat({frame(sendMessage("hi")), frame(sendMessage("hi"))}), 7), .messages = 2},
+    {.name = "large frame over many reads", .chunks = split(frame(sendMessage(LONG_MESSAGE)), 4096), .messages = 1},
+    {.name = "frame size of 11 bytes", .chunks = split(cat({{FRAME}, std::vector<uint8_t>(10, 0x80), {0x01, 0x00}}), 1)},
+    {.name = "frame fd count of 11 bytes", .chunks = split(cat({{FRAME}, varInt(16), std::vector<uint8_t>(10, 0x80), {0x00}}), 1)},
+    {.name = "frame over the size limit", .chunks = {cat({{FRAME}, varInt(MAX_FRAME_SIZE + 1)})}},
+};
+
+static SP<CMyManagerV1Object> manager;
+static size_t                 accepted = 0;
+
+static SP<CTestProtocolV1Impl> spec = makeShared<CTestProtocolV1Impl>(TEST_PROTOCOL_VERSION, [](SP<Hyprwire::IObject> obj) {
+    manager = makeShared<CMyManagerV1Object>(std::move(obj));
+    manager->setSendMessage([](const char* msg) { accepted += std::string_view{msg} == "hi" || std::string_view{msg} == LONG_MESSAGE; });
+});
+
+static SP<CCTestProtocolV1Impl> impl = makeShared<CCTestProtocolV1Impl>(TEST_PROTOCOL_VERSION);
+
+// true once the server read the last chunk, false if it has something to say first (it's dropping us)
+static bool waitForRead(int fd, int sync) {
+    pollfd pfds[2] = {{.fd = sync, .events = POLLIN, .revents = 0}, {.fd = fd, .events = POLLIN, .revents = 0}};
+    if (poll(pfds, 2, -1) <= 0 || pfds[1].revents)
+        return false;
+
+    char token = 0;
+    return read(sync, &token, 1) == 1;
+}
+
+// binds the manager like any client, then writes the chunks behind the library's back, waiting on sync after each
+static int client(int fd, int sync, const SCase& c) {
+    alarm(10);
+
+    auto sock = Hyprwire::IClientSocket::open(fd);
+    sock->addImplementation(impl);
+
+    if (!sock->waitForHandshake() || !sock->bindProtocol(impl->protocol(), TEST_PROTOCOL_VERSION))
+        return 1;
+
+    sock->roundtrip();
+
+    for (const auto& chunk : c.chunks) {
+        if (write(fd, chunk.data(), chunk.size()) != sc<ssize_t>(chunk.size()) || !waitForRead(fd, sync))
+            break;
+    }
+
+    if (c.messages) {
+        sock->roundtrip();
+        return sock->dispatchEvents(false) ? 0 : 1;
+    }
+
+    while (sock->dispatchEvents(true)) {
+        ;
+    }
+
+    return 0;
+}
+
+int main(int argc, char** argv, char** envp) {
+    // frames, without client ids so the manager's id is known
+    setenv("HW_CLIENT_FEATURES", "0xfffffffe", 1);
+    signal(SIGPIPE, SIG_IGN);
+
+    auto serverSock = Hyprwire::IServerSocket::open();
+    serverSock->addImplementation(spec);
+
+    size_t passed = 0;
+
+    for (const auto& c : CASES) {
+        int sockFds[2], syncFds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockFds) || pipe(syncFds))
+            return 1;
+
+        pid_t chld = fork();
+        if (chld < 0)
+            return 1;
+
+        if (chld == 0) {
+            close(sockFds[0]);
+            close(syncFds[1]);
+            _exit(client(sockFds[1], syncFds[0], c));
+        }
+
+        close(sockFds[1]);
+        close(syncFds[0]);
+
+        accepted = 0;
+        serverSock->addClient(sockFds[0]);
+
+        // every dispatch lets the client write its next chunk, so each one is a read of its own
+        pollfd pfd    = {.fd = serverSock->extractLoopFD(), .events = POLLIN, .revents = 0};
+        int    status = 0;
+        while (waitpid(chld, &status, WNOHANG) == 0) {
+            if (poll(&pfd, 1, 10) <= 0)
+                continue;
+
+            serverSock->dispatchEvents(false);
+            write(syncFds[1], "", 1);
+        }
+
+        // let the server see the hangup
+        serverSock->dispatchEvents(false);
+        close(syncFds[1]);
+
+        const bool OK = WIFEXITED(status) && WEXITSTATUS(status) == 0 && accepted == c.messages;
+        std::println("{}: {}", c.name, OK ? (c.messages ? "accepted" : "rejected") : "FAILED");
+        passed += OK;
+    }
+
+    std::println("{}/{} cases passed", passed, CASES.size());
+
+    return passed == CASES.size() ? 0 : 1;
+}
@@ -0,0 +1,182 @@
+#include <hyprwire/hyprwire.hpp>
+#include <hyprwire/core/types/MessageMagic.hpp>
+#include <cstring>
+#include <print>
+#include <sys/poll.h>
+#include <sys/signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "generated/test_protocol_v1-server.hpp"
+#include "generated/test_protocol_v1-client.hpp"
+
+using namespace Hyprutils::Memory;
+using namespace Hyprwire;
+
+#define SP CSharedPointer
+
+constexpr const uint32_t TEST_PROTOCOL_VERSION = 1;
+
+// GENERIC_PROTOCOL_MESSAGE on the wire, and the manager's id: the first object of a client without client ids
+constexpr const uint8_t  GENERIC_PROTOCOL_MESSAGE = 100;
+constexpr const uint32_t MANAGER_ID               = 1;
+
+// my_manager_v1 c2s methods
+constexpr const uint32_t SEND_MESSAGE       = 0;
+constexpr const uint32_t SEND_MESSAGE_ARRAY = 3;
+constexpr const uint32_t SEND_WINDOWS       = 6;
+
+// struct:window, 5 fields of 4 bytes
+constexpr const uint64_t WINDOW_SIZE = 20;
+
+struct SCase {
+    const char*          name;
+    uint32_t             method = 0;
+    std::vector<uint8_t> args;
+    bool                 valid = false;
+};
+
+static std::vector<uint8_t> varInt(uint64_t value) {
+    std::vector<uint8_t> data;
+    do {
+        data.emplace_back((value & 0x7F) | (value > 0x7F ? 0x80 : 0));
+        value >>= 7;
+    } while (value);
+    return data;
+}
+
+static std::vector<uint8_t> cat(std::initializer_list<std::vector<uint8_t>> parts) {
+    std::vector<uint8_t> data;
+    for (const auto& p : parts) {
+        data.append_range(p);
+    }
+    return data;
+}
+
+static std::vector<uint8_t> message(uint32_t method, const std::vector<uint8_t>& args) {
+    std::vector<uint8_t> data = {GENERIC_PROTOCOL_MESSAGE, HW_MESSAGE_MAGIC_TYPE_OBJECT, 0, 0, 0, 0, HW_MESSAGE_MAGIC_TYPE_UINT, 0, 0, 0, 0};
+    std::memcpy(&data[2], &MANAGER_ID, sizeof(MANAGER_ID));
+    std::memcpy(&data[7], &method, sizeof(method));
+    data.append_range(args);
+    data.emplace_back(HW_MESSAGE_MAGIC_END);
+    return data;
+}
+
+static const std::vector<SCase> CASES = {
+    {.name = "well-formed varchar", .method = SEND_MESSAGE, .args = cat({{HW_MESSAGE_MAGIC_TYPE_VARCHAR}, varInt(2), {'h', 'i'}}), .valid = true},
+    {.name = "varchar past the end", .method = SEND_MESSAGE, .args = cat({{HW_MESSAGE_MAGIC_TYPE_VARCHAR}, varInt(100), {'h', 'i'}})},
+    {.name = "varchar length wrapping around", .method = SEND_MESSAGE, .args = cat({{HW_MESSAGE_MAGIC_TYPE_VARCHAR}, varInt(UINT64_MAX - 10), {'h', 'i'}})},
+    {.name   = "varchar length of 11 bytes",
+     .method = SEND_MESSAGE,
+     .args   = cat({{HW_MESSAGE_MAGIC_TYPE_VARCHAR}, std::vector<uint8_t>(10, 0x80), {0x00, 'h', 'i'}})},
+    {.name = "varchar longer than 4 GiB", .method = SEND_MESSAGE, .args = cat({{HW_MESSAGE_MAGIC_TYPE_VARCHAR}, varInt(1ULL << 32), {'h', 'i'}})},
+    {.name   = "string array past the end",
+     .method = SEND_MESSAGE_ARRAY,
+     .args   = cat({{HW_MESSAGE_MAGIC_TYPE_ARRAY, HW_MESSAGE_MAGIC_TYPE_VARCHAR}, varInt(2), varInt(1), {'a'}, varInt(50), {'b'}})},
+    {.name   = "well-formed struct array",
+     .method = SEND_WINDOWS,
+     .args   = cat({{HW_MESSAGE_MAGIC_TYPE_ARRAY, HW_MESSAGE_MAGIC_TYPE_STRUCT}, varInt(1), varInt(WINDOW_SIZE), std::vector<uint8_t>(WINDOW_SIZE, 1)}),
+     .valid  = true},
+    {.name   = "structs past the end",
+     .method = SEND_WINDOWS,
+     .args   = cat({{HW_MESSAGE_MAGIC_TYPE_ARRAY, HW_MESSAGE_MAGIC_TYPE_STRUCT}, varInt(3), varInt(WINDOW_SIZE), std::vector<uint8_t>(WINDOW_SIZE, 1)})},
+    {.name   = "struct count overflowing the size",
+     .method = SEND_WINDOWS,
+     .args   = cat({{HW_MESSAGE_MAGIC_TYPE_ARRAY, HW_MESSAGE_MAGIC_TYPE_STRUCT}, varInt(1ULL << 62), varInt(WINDOW_SIZE)})},
+    {.name   = "struct size overflowing the size",
+     .method = SEND_WINDOWS,
+     .args   = cat({{HW_MESSAGE_MAGIC_TYPE_ARRAY, HW_MESSAGE_MAGIC_TYPE_STRUCT}, varInt(4), varInt(1ULL << 62)})},
+    {.name   = "zero-sized structs",
+     .method = SEND_WINDOWS,
+     .args   = cat({{HW_MESSAGE_MAGIC_TYPE_ARRAY, HW_MESSAGE_MAGIC_TYPE_STRUCT}, varInt(UINT32_MAX), varInt(0)})},
+};
+
+static SP<CMyManagerV1Object> manager;
+static bool                   accepted = false;
+
+static SP<CTestProtocolV1Impl> spec = makeShared<CTestProtocolV1Impl>(TEST_PROTOCOL_VERSION, [](SP<Hyprwire::IObject> obj) {
+    manager = makeShared<CMyManagerV1Object>(std::move(obj));
+    manager->setSendMessage([](const char* msg) { accepted = true; });
+    manager->setSendMessageArray([](std::vector<const char*> data) { accepted = true; });
+    manager->setSendWindows([](const std::vector<STestProtocolV1Window>& windows) { accepted = true; });
+});
+
+static SP<CCTestProtocolV1Impl> impl = makeShared<CCTestProtocolV1Impl>(TEST_PROTOCOL_VERSION);
+
+// binds the manager like any client, then writes raw bytes behind the library's back. The server has to drop us for a malformed one.
+static int client(int fd, const SCase& c) {
+    alarm(5);
+
+    auto sock = Hyprwire::IClientSocket::open(fd);
+    sock->addImplementation(impl);
+
+    if (!sock->waitForHandshake() || !sock->bindProtocol(impl->protocol(), TEST_PROTOCOL_VERSION))
+        return 1;
+
+    sock->roundtrip();
+
+    const auto RAW = message(c.method, c.args);
+    if (write(fd, RAW.data(), RAW.size()) != sc<ssize_t>(RAW.size()))
+        return 1;
+
+    if (c.valid) {
+        sock->roundtrip();
+        return sock->dispatchEvents(false) ? 0 : 1;
+    }
+
+    while (sock->dispatchEvents(true)) {
+        ;
+    }
+
+    return 0;
+}
+
+int main(int argc, char** argv, char** envp) {
+    // plain messages, no frames or compact ones
+    setenv("HW_CLIENT_FEATURES", "0", 1);
+    signal(SIGPIPE, SIG_IGN);
+
+    auto serverSock = Hyprwire::IServerSocket::open();
+    serverSock->addImplementation(spec);
+
+    size_t passed = 0;
+
+    for (const auto& c : CASES) {
+        int sockFds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockFds))
+            return 1;
+
+        pid_t chld = fork();
+        if (chld < 0)
+            return 1;
+
+        if (chld == 0) {
+            close(sockFds[0]);
+            _exit(client(sockFds[1], c));
+        }
+
+        close(sockFds[1]);
+
+        accepted = false;
+        serverSock->addClient(sockFds[0]);
+
+        pollfd pfd    = {.fd = serverSock->extractLoopFD(), .events = POLLIN, .revents = 0};
+        int    status = 0;
+        while (waitpid(chld, &status, WNOHANG) == 0) {
+            if (poll(&pfd, 1, 10) > 0)
+                serverSock->dispatchEvents(false);
+        }
+
+        // let the server see the hangup
+        serverSock->dispatchEvents(false);
+
+        const bool OK = WIFEXITED(status) && WEXITSTATUS(status) == 0 && accepted == c.valid;
+        std::println("{}: {}", c.name, OK ? (c.valid ? "accepted" : "rejected") : "FAILED");
+        passed += OK;
+    }
+
+    std::println("{}/{} cases passed", passed, CASES.size());
+
+    return passed == CASES.size() ? 0 : 1;
+}
@@ -0,0 +1,127 @@
+#include <hyprwire/hyprwire.hpp>
+#include <format>
+#include <print>
+#include <sys/poll.h>
+#include <sys/signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "generated/test_protocol_v1-server.hpp"
+#include "generated/test_protocol_v1-client.hpp"
+
+using namespace Hyprutils::Memory;
+
+#define SP CSharedPointer
+
+constexpr const uint32_t TEST_PROTOCOL_VERSION = 1;
+
+// more different strings than the table holds (256), so old ones get evicted and defined again
+constexpr const size_t MESSAGES = 3000;
+
+// the string after the last message, interned by a call that fails. It has to go out anyway.
+static const std::string NAME = "never sent before";
+
+static std::string       message(size_t i) {
+    if (i == MESSAGES)
+        return NAME;
+
+    // too short for an id
+    if (i % 11 == 0)
+        return "hi";
+
+    // once only
+    if (i % 7 == 0)
+        return std::format("unique-{}", i);
+
+    return std::format("app-id-{}", (i * 37) % 400);
+}
+
+static SP<CMyManagerV1Object>             manager;
+static std::vector<SP<CMyObjectV1Object>> objects;
+static SP<Hyprwire::IServerSocket>        serverSock;
+static size_t                             got = 0, bad = 0;
+
+static SP<CTestProtocolV1Impl>            spec = makeShared<CTestProtocolV1Impl>(TEST_PROTOCOL_VERSION, [](SP<Hyprwire::IObject> obj) {
+    manager = makeShared<CMyManagerV1Object>(std::move(obj));
+
+    // every message comes back, so the server's table gets the same workout
+    manager->setSendMessage([](const char* msg) {
+        bad += msg != message(got++);
+        manager->sendSendMessage(msg);
+    });
+    manager->setMakeObject([](uint32_t seq) {
+        objects.emplace_back(makeShared<CMyObjectV1Object>(serverSock->createObject(manager->getObject()->client(), manager->getObject(), "my_object_v1", seq)));
+    });
+    manager->setSendNamedObject([](const char* name, CMyObjectV1Object* object) { bad++; });
+});
+
+static SP<CCTestProtocolV1Impl> impl = makeShared<CCTestProtocolV1Impl>(TEST_PROTOCOL_VERSION);
+
+static int                      client(int fd) {
+    alarm(10);
+
+    auto sock = Hyprwire::IClientSocket::open(fd);
+    sock->addImplementation(impl);
+
+    if (!sock->waitForHandshake())
+        return 1;
+
+    auto   cmanager = makeShared<CCMyManagerV1Object>(sock->bindProtocol(impl->protocol(), TEST_PROTOCOL_VERSION));
+    size_t echoed = 0, badEchoes = 0;
+    cmanager->setSendMessage([&](const char* msg) { badEchoes += msg != message(echoed++); });
+
+    for (size_t i = 0; i < MESSAGES; ++i) {
+        cmanager->sendSendMessage(message(i).c_str());
+    }
+
+    // the object doesn't have an id until the server says so, which fails the call after its name got an id
+    auto cobject = makeShared<CCMyObjectV1Object>(cmanager->sendMakeObject());
+    cmanager->sendSendNamedObject(NAME.c_str(), cobject.get());
+    cmanager->sendSendMessage(NAME.c_str());
+
+    while (echoed < MESSAGES + 1 && sock->dispatchEvents(true)) {
+        ;
+    }
+
+    sock->roundtrip();
+
+    std::println("client: got {} back, {} bad", echoed, badEchoes);
+
+    return echoed == MESSAGES + 1 && !badEchoes ? 0 : 1;
+}
+
+int main(int argc, char** argv, char** envp) {
+    // without client ids, so a new object has to wait for its id
+    setenv("HW_CLIENT_FEATURES", "0xfffffffe", 1);
+
+    int sockFds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockFds))
+        return 1;
+
+    pid_t chld = fork();
+    if (chld < 0)
+        return 1;
+
+    if (chld == 0) {
+        close(sockFds[0]);
+        _exit(client(sockFds[1]));
+    }
+
+    close(sockFds[1]);
+
+    serverSock = Hyprwire::IServerSocket::open();
+    serverSock->addImplementation(spec);
+    serverSock->addClient(sockFds[0]);
+
+    pollfd pfd    = {.fd = serverSock->extractLoopFD(), .events = POLLIN, .revents = 0};
+    int    status = 0;
+    while (waitpid(chld, &status, WNOHANG) == 0) {
+        if (poll(&pfd, 1, 10) > 0)
+            serverSock->dispatchEvents(false);
+    }
+
+    std::println("server: got {}, {} bad", got, bad);
+
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0 && got == MESSAGES + 1 && !bad ? 0 : 1;
+}